@@ -30,6 +30,7 @@
 #include <tulip/ColorProperty.h>
 
 #include "Dijkstra.h"
+#include "paths.h"
 
 #include "fabric.h"
 #include "ibautils/ib_fabric.h"
@@ -41,92 +42,23 @@ using namespace std;
 
 PLUGIN(Dijkstra)
 
+static const char * paramHelp[] = {
+  // Weight
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "NumericProperty" ) \
+  HTML_HELP_DEF( "default", "none" ) \
+  HTML_HELP_BODY() \
+  "Optional edge weights. Without weights every edge counts as 1 hop and a BFS is used." \
+  HTML_HELP_CLOSE()
+};
+
 //Constructor
 Dijkstra::Dijkstra(tlp::PluginContext* context)
 : tlp::Algorithm(context){
+    addInParameter<NumericProperty*>("Weight", paramHelp[0], "", false);
 }
 
-
-//Find minimum distance between two nodes
-int Dijkstra::nodes_map::min_distance(map<int, Dijkstra::nodes_map::myNode*> map1, bool visited[]){
-    int min = INT_MAX;
-    int min_index = 0;
-
-    for(int i = 0; i<v; i++){
-        if(!visited[i] && map1[i]->getDist() < min)
-            min = map1[i]->getDist(), min_index = i;
-    }
-
-    return min_index;
-}
-
-
-//Print
-void Dijkstra::nodes_map::printResult(map<int, Dijkstra::nodes_map::myNode*> map1) {
-    for(int i = 0; i<v; i++){
-        cout<<i<<" is from: "<<map1[i]->getFrom()<<" its distance is: "<<map1[i]->getDist()<<endl;
-    }
-}
-
-
-//Apply Dijkstra's Algorithm
-map<int,Dijkstra::nodes_map::myNode*> Dijkstra::nodes_map::dijkstra(int src) {
-    map<int, Dijkstra::nodes_map::myNode*> distmap;
-    bool visited[v];
-
-    for (int i = 0; i < v; i++) {
-        distmap[i] = new Dijkstra::nodes_map::myNode(i, INT_MAX);
-        visited[i] = false;
-    }
-    distmap[src]->setDist(0);
-
-    for (int count = 0; count < v - 1; count++) {
-        int u = min_distance(distmap, visited);
-        visited[u] = true;
-
-        for (int i = 0; i < v; i++) {
-            if (!visited[i] && adjacent_matrix[u][i] && distmap[u]->getDist() != INT_MAX &&
-                distmap[u]->getDist() + adjacent_matrix[u][i] < distmap[i]->getDist())
-            {
-                distmap[i]->setDist(distmap[u]->getDist() + adjacent_matrix[u][i]);
-                distmap[i]->setFrom(u);
-            }
-        }
-    }
-    
-    return distmap;
-}
-
-//Trace back the path suggested by Dijkstra
-vector<unsigned int> Dijkstra::nodes_map::tracePath(map<int, Dijkstra::nodes_map::myNode*> distmap, int target, int src){
-    cout<<"the destination is: "<<target<<endl;
-    vector<unsigned int> path;
-    int pos = target;
-    for(int i = 0; i<v-1; i++){
-       path.push_back(pos);
-       cout<<"<--"<<distmap[pos]->getFrom()<<" ";
-       pos = distmap[pos]->getFrom();
-       if(pos == src){
-         path.push_back(pos);
-         break;
-       }
-    }
-    cout<<" "<<endl;
-   
-   return path;
-}
-
-
-//Find node from its id
-const tlp::node & Dijkstra::find_node(unsigned int id){
-     tlp::Iterator<tlp::node> *itnodes = graph->getNodes();
-       
-       while(itnodes->hasNext()){
-          const tlp::node &node = itnodes->next();
-             if(node.id == id)
-                return node;  
-       }
-}
+namespace ib = infiniband;
 
 //Tulip's main function
 bool Dijkstra::run()
@@ -143,15 +75,10 @@ bool Dijkstra::run()
         pluginProgress->progress(0, STEPS);
     }
    
-    //Get the total number of nodes 'v'
-    tlp::Iterator<tlp::node> *itnod = graph->getNodes();
-
-    int v = 0; 
-    while(itnod->hasNext()){
-       itnod->next();
-        v++;
-    }
-   
+    //Optional edge weights
+    NumericProperty *weight = NULL;
+    if(dataSet)
+        dataSet->get("Weight", weight);
         
     //Tulip's selection algorithm
     BooleanProperty *selectBool = graph->getLocalProperty<BooleanProperty>("viewSelection"); //Tulip's Boolean Property to access "viewSelection."
@@ -172,11 +99,13 @@ bool Dijkstra::run()
            if(pluginProgress)
              pluginProgress->setError("More than one node is selected");
 
+           delete selections;
            return false;
          }
       
         path_node[path_id++] = mynode.id;
     }
+    delete selections;
 
     //If no node is selected show the error
     if(path_id == 0)
@@ -193,26 +122,38 @@ bool Dijkstra::run()
         pluginProgress->progress(1, STEPS);
     }
    
-    nodes_map *graphAnalysis = new nodes_map(graph,v);
-    
-    map<int, Dijkstra::nodes_map::myNode*> mymap = graphAnalysis->dijkstra(path_node[0]);
+    //Walk the shared adjacency snapshot: BFS unless weights are given
+    const ib::adjacency_t &adjacency = ib::adjacency_t::find(graph);
+    ib::shortest_paths_t paths(adjacency);
+    const ib::adjacency_t::index_t source = adjacency.index(tlp::node(path_node[0]));
+    if(source == ib::adjacency_t::INVALID_INDEX)
+    {
+      if(pluginProgress)
+        pluginProgress->setError("Selected node is not part of the graph");
 
-    int max = 1;
-    
-        if(pluginProgress)
+      return false;
+    }
+
+    if(weight)
+        paths.dijkstra(source, ib::shortest_paths_t::arc_weights(graph, adjacency, weight));
+    else
+        paths.bfs(source);
+
+    if(pluginProgress)
     {
         pluginProgress->setComment("Calculating the minimum distances..");
         pluginProgress->progress(2, STEPS);
     }
     
-    //Print Distance and find out the max and min numbers
-    for(int i = 0; i<v; i++){
-        max = std::max(max,mymap[i]->getDist());
-        cout<<"Node id: "<<i<<" ---- The shortest distance: "<<mymap[i]->getDist()<<endl;
+#ifndef NDEBUG
+    //Print Distance for every node
+    for(ib::adjacency_t::index_t i = 0; i<adjacency.size(); i++){
+        cout<<"Node id: "<<adjacency.node(i).id<<" ---- The shortest distance: "<<paths.distance(i)<<endl;
     }
    
     cout<<"*************************************************************************"<<endl;
     cout<<""<<endl;
+#endif
    
     tlp::IntegerProperty * ibHop = graph->getProperty<tlp::IntegerProperty>("ibHop");
     assert(ibHop);
@@ -223,11 +164,10 @@ bool Dijkstra::run()
         pluginProgress->progress(3, STEPS);
     }
 
-    tlp::Iterator<tlp::node> *itnodes = graph->getNodes();
-    while(itnodes->hasNext()){
-        const tlp::node &node = itnodes->next();
-        const int &temp = mymap[node.id]->getDist();
-        ibHop->setNodeValue(node, temp);
+    //Unreachable nodes keep INT_MAX as before
+    for(ib::adjacency_t::index_t i = 0; i<adjacency.size(); i++){
+        const ib::shortest_paths_t::distance_t dist = paths.distance(i);
+        ibHop->setNodeValue(adjacency.node(i), dist == ib::shortest_paths_t::UNREACHABLE ? INT_MAX : static_cast<int>(dist));
     }
    
     if(pluginProgress)
@@ -238,18 +178,3 @@ bool Dijkstra::run()
 
     return true;
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
@@ -43,79 +43,7 @@ public:
 //Constructor
     Dijkstra(tlp::PluginContext* context);
     
-//Declaration of adjacency matrix
-    class nodes_map{
-    private:
-        int v; //number of nodes;
-        int **adjacent_matrix;
-    public:
-        class myNode{
-           int from;
-           int dist;
-        public:
-            myNode(int from, int dist = INT_MAX){
-                this->from = from;
-                this->dist = dist;
-            };
-
-            void setDist(int d){dist = d; }
-            int getDist(){return dist;}
-
-            void setFrom(int f){from = f;}
-            int getFrom(){return from;}
-
-        };
-
-    nodes_map(const Graph *graph, int v){
-        initMap(graph, v);
-    }
-    ~nodes_map(){
-        delete adjacent_matrix[v];
-    }
-
-    void initMap(const Graph *graph, int v){
-        this->v = v;
-        adjacent_matrix = new int* [v];
-        for(int i = 0; i<v; i++){
-            adjacent_matrix[i] = new int[v];
-        }
-
-        //Initialize the adjacent_matrix
-        for(int i = 0; i<v; i++){
-            for(int j = 0; j<v; j++){
-                adjacent_matrix[i][j] = 0;
-            }
-        }
-
-        //Initialize the adjacency matrix
-        tlp::Iterator<edge> *ite = graph->getEdges();
-        while(ite->hasNext()){
-            edge e = ite->next();
-            int s = graph->source(e).id, t = graph->target(e).id;
-            if(!adjacent_matrix[s][t]){
-                adjacent_matrix[s][t] = 1;
-                adjacent_matrix[t][s] = 1;
-            }
-        }
-    }
- 
-//Calculate minimun distance between two nodes
-    int min_distance(map<int, myNode*> map1, bool visited[]);
-        
-//Implement Dijkstra's algorithm on the graph
-    map<int,myNode*> dijkstra(int src);
-        
-//Print the results in the terminal
-    void printResult(map<int, myNode*> map1);
-        
-//Trace the route suggested by Dijkstra's algorithm
-    vector<unsigned int> tracePath(map<int, myNode*> distmap, int target,int src);
-    };
-
 //Main function for tulip
     bool run();
-    
-//Return a node from its id
-    const tlp::node & find_node(unsigned int id); //Get node form id
 };
 #endif //DIJKSTRA_H
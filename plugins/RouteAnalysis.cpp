@@ -37,6 +37,7 @@
 #include <tulip/IntegerProperty.h>
 #include <tulip/ColorProperty.h>
 #include "fabric.h"
+#include "forwarding.h"
 #include "ibautils/ib_fabric.h"
 #include "ibautils/ib_parser.h"
 #include "ibautils/ib_port.h"
@@ -53,7 +54,7 @@ static const char * paramHelp[] = {
   HTML_HELP_OPEN() \
   HTML_HELP_DEF( "type", "pathname" ) \
   HTML_HELP_BODY() \
-  "Path to ibdiagnet2.fdbs file to import" \
+  "Path to ibdiagnet2.fdbs file to import (plain, gzip or zstd)" \
   HTML_HELP_CLOSE()
 
 };
@@ -68,13 +69,9 @@ RouteAnalysis::RouteAnalysis(tlp::PluginContext* context)
 namespace ib = infiniband;
 namespace ibp = infiniband::parser;
 
-//Find the entity based on node in the fabric : tulip_fabric_t
+//Find the entity based on node in the fabric : tulip_fabric_t (O(1) reverse index)
 const ib::entity_t * RouteAnalysis::getMyEntity(const tlp::node node,ib::tulip_fabric_t * const fabric){
-    for(ib::tulip_fabric_t::entity_nodes_t::iterator it1 = fabric->entity_nodes.begin(); it1 != fabric->entity_nodes.end(); ++it1)
-        if(it1->second.id == node.id)
-            return it1->first;
-
-    return nullptr;
+    return fabric->get_node_entity(node);
 }
 
 bool RouteAnalysis::run(){
@@ -115,14 +112,6 @@ bool RouteAnalysis::run(){
     std::string filename;
 
     dataSet->get("file::filename", filename);
-    std::ifstream ifs(filename.c_str());
-    if(!ifs)
-    {
-        if(pluginProgress)
-            pluginProgress->setError("Unable open source file.");
-
-        return false;
-    }
 
     if(pluginProgress)
     {
@@ -130,11 +119,10 @@ bool RouteAnalysis::run(){
         pluginProgress->setComment("Parsing Routes.");
     }
 
-    ibp::ibdiagnet_fwd_db parser;
-    if(!parser.parse(*fabric, ifs))
+    if(!fabric->load_routes(filename))
     {
         if(pluginProgress)
-            pluginProgress->setError("Unable parse routes file.");
+            pluginProgress->setError("Unable open or parse routes file.");
 
         return false;
     }
@@ -145,12 +133,8 @@ bool RouteAnalysis::run(){
         pluginProgress->progress(3, STEPS);
     }
 
-    ifs.close();
-
-
     //Find the source and target nodes of the path
     BooleanProperty *selectBool = graph->getLocalProperty<BooleanProperty>("viewSelection");
-    IntegerProperty *getPortNum = graph->getLocalProperty<IntegerProperty>("ibPortNum");
     vector<tlp::node> nodes;
 
     //Find the selected node in the graph
@@ -160,197 +144,53 @@ bool RouteAnalysis::run(){
         const tlp::node &mynode = selections->next();
         nodes.push_back(mynode);
     }
-  
-    //Print source node id and target node id in the terminal
-    cout<<"Test the size of vector: "<<nodes.size()<<endl;
-    cout<<"source_node_id: "<<nodes[0].id<<endl;
-    cout<<"target_node_id: "<<nodes[1].id<<endl;
-    cout<<" -------------------------------- "<<endl;
+    delete selections;
 
-    const ib::entity_t * source_entity = getMyEntity(nodes[0],fabric);
-    const ib::entity_t * target_entity = getMyEntity(nodes[1],fabric);
+    if(nodes.size() != 2)
+    {
+        if(pluginProgress)
+            pluginProgress->setError("Select exactly two nodes");
 
-    //Print source entity guid and target entity guid in the terminal
-    cout<<"source_guid: "<<source_entity->guid<<endl;
-    cout<<"target_guid: "<<target_entity->guid<<endl;
-    cout<<" -------------------------------- "<<endl;
+        return false;
+    }
 
+    //Every switch forwards the target LID through one port of its LFT
+    const ib::forwarding_t &forwarding = fabric->get_forwarding();
+    const ib::forwarding_t::index_t source = forwarding.index(nodes[0]);
+    const ib::forwarding_t::index_t target = forwarding.index(nodes[1]);
+    if(source == ib::forwarding_t::INVALID_INDEX || target == ib::forwarding_t::INVALID_INDEX)
+    {
+        if(pluginProgress)
+            pluginProgress->setError("Selected nodes are not part of the fabric");
+
+        return false;
+    }
 
-    //ib::lid_t target_lid = target_entity->lid();
-    std::vector<ib::entity_t *> tmp;
+    const ib::lid_t target_lid = forwarding.entity(target)->lid();
 
     // Use to count the number of hops;
     unsigned int count_hops = 0;
 
-    // Whether the souce node is HCA or not
-    if(getPortNum->getNodeValue(nodes[0])== 1){
-        //find the only port in HCA
-        const ib::entity_t::portmap_t::const_iterator Myport = source_entity->ports.begin();
-
-        //use the typedef std::map<port_t*, tlp::edge> port_edges_t to find the edge
-        ib::tulip_fabric_t::port_edges_t::iterator Myedge = fabric->port_edges.find(Myport->second);
-        selectBool->setEdgeValue(Myedge->second, true);
-        if(graph->source(Myedge->second).id == nodes[0].id){
-            const tlp::edge &e = Myedge->second;
-            tmp.push_back(const_cast<ib::entity_t *> (getMyEntity(graph->target(e),fabric)));
-            selectBool->setNodeValue(graph->target(e), true);
-        }else{
-            const tlp::edge &e = Myedge->second;
-            tmp.push_back(const_cast<ib::entity_t *> (getMyEntity(graph->source(e),fabric)));
-            selectBool->setNodeValue(graph->source(e), true);
-        }
-    }else{
-
-        tmp.push_back(const_cast<ib::entity_t *> (source_entity));
-    }
+    for(ib::forwarding_t::index_t current = source; current != target; ++count_hops){
+        cout<<"The "<<count_hops<<" step: "<<forwarding.entity(current)->guid<<endl;
 
-    cout<<"tmp vector size: "<<tmp.size()<<endl;
-    cout<<tmp.back()->guid<<endl;
-    cout<<"----------test source entity end---------------"<<endl;
-    
-    //Whether the target is HCE or not
-    if(getPortNum->getNodeValue(nodes[1])== 1){
-        //find the only port in HCA
-        const ib::entity_t::portmap_t::const_iterator Myport = target_entity->ports.begin();
-
-        //use the typedef std::map<port_t*, tlp::edge> port_edges_t to find the edge
-        ib::tulip_fabric_t::port_edges_t::iterator Myedge = fabric->port_edges.find(Myport->second);
-
-        selectBool->setEdgeValue(Myedge->second, true);
-        if(graph->source(Myedge->second).id == nodes[1].id){
-            const tlp::edge &e = Myedge->second;
-            const ib::entity_t * real_target = getMyEntity(graph->target(e),fabric);
-            ib::lid_t target_lid = real_target->lid();
-            while(tmp.back()->guid!= real_target->guid) {
-                const ib::entity_t & temp = *tmp.back();
-                cout<<"The "<<count_hops<<" step: "<<temp.guid<<endl;
-                for (
-                        ib::entity_t::routes_t::const_iterator
-                                ritr = temp.get_routes().begin(),
-                                reitr = temp.get_routes().end();
-                        ritr != reitr;
-                        ++ritr
-                        ) {
-                    std::set<ib::lid_t>::const_iterator itr = ritr->second.find(target_lid);
-                    if (itr != ritr->second.end()) {
-                        const ib::entity_t::portmap_t::const_iterator port_itr = temp.ports.find(ritr->first);
-                        if (port_itr != temp.ports.end()) {
-                            const ib::port_t *const port = port_itr->second;
-                            const ib::tulip_fabric_t::port_edges_t::const_iterator edge_itr = fabric->port_edges.find(
-                                    const_cast<ib::port_t *>(port));
-                            if (edge_itr != fabric->port_edges.end()) {
-                                const tlp::edge &edge = edge_itr->second;
-                                selectBool->setEdgeValue(edge, true);
-                                const ib::entity_t * node = getMyEntity(graph->target(edge),fabric);
-                                selectBool->setNodeValue(graph->target(edge), true);
-                                tmp.push_back(const_cast<ib::entity_t *> (node));
-                                count_hops++;
-                            }
-                        }
-                    }
-                }
-            }
-            cout<<"The "<<count_hops<<" step: "<<real_target->guid<<endl;
-
-        }else{
-            //find the only port in HCA
-            const ib::entity_t::portmap_t::const_iterator Myport = target_entity->ports.begin();
-
-            //use the typedef std::map<port_t*, tlp::edge> port_edges_t to find the edge
-            ib::tulip_fabric_t::port_edges_t::iterator Myedge = fabric->port_edges.find(Myport->second);
-            const tlp::edge &e = Myedge->second;
-            selectBool->setEdgeValue(e, true);
-            const ib::entity_t * real_target = getMyEntity(graph->source(e),fabric);
-            ib::lid_t target_lid = real_target->lid();
-            while(tmp.back()->guid!= real_target->guid) {
-                const ib::entity_t & temp = *tmp.back();
-                cout<<"The "<<count_hops<<" step: "<<temp.guid<<endl;
-                for (
-                        ib::entity_t::routes_t::const_iterator
-                                ritr = temp.get_routes().begin(),
-                                reitr = temp.get_routes().end();
-                        ritr != reitr;
-                        ++ritr
-                        ) {
-
-                    std::set<ib::lid_t>::const_iterator itr = ritr->second.find(target_lid);
-                    if (itr != ritr->second.end()) {
-                        const ib::entity_t::portmap_t::const_iterator port_itr = temp.ports.find(ritr->first);
-                        if (port_itr != temp.ports.end()) {
-                            const ib::port_t *const port = port_itr->second;
-                            const ib::tulip_fabric_t::port_edges_t::const_iterator edge_itr = fabric->port_edges.find(
-                                    const_cast<ib::port_t *>(port));
-                            if (edge_itr != fabric->port_edges.end()) {
-                                const tlp::edge &edge = edge_itr->second;
-                                selectBool->setNodeValue(graph->target(edge), true);
-                                selectBool->setEdgeValue(edge, true);
-                                const ib::entity_t * node = getMyEntity(graph->target(edge),fabric);
-                                tmp.push_back(const_cast<ib::entity_t *> (node));
-                                count_hops++;
-                            }
-                        }
-                    }else{
-
-                        cout<<"Do not find routesmap"<<endl;
-                    }
-                }
-            }
-            cout<<"The "<<count_hops<<" step: "<<real_target->guid<<endl;
+        const ib::forwarding_t::hop_t hop = forwarding.next(current, target_lid);
+        if(hop.entity == ib::forwarding_t::INVALID_INDEX || count_hops >= forwarding.size())
+        {
+            if(pluginProgress)
+                pluginProgress->setError("No route between the selected nodes");
 
+            return false;
         }
 
-
-        cout<<"The "<<++count_hops<<" step: "<<target_entity->guid<<endl;
-        cout<<" ------------------------" <<endl;
-        cout<<"The total hops: "<<count_hops<<endl;
+        selectBool->setEdgeValue(hop.edge, true);
+        selectBool->setNodeValue(forwarding.node(hop.entity), true);
+        current = hop.entity;
     }
-    else{
-        ib::lid_t target_lid = target_entity->lid();
-        while(tmp.back()->guid!= target_entity->guid) {
-            const ib::entity_t *temp = tmp.back();
-            bool find_next = false;
-            cout<<"The "<<count_hops<<" step: "<<temp->guid<<endl;
-            for (
-                    ib::entity_t::routes_t::const_iterator
-                            ritr = temp->get_routes().begin(),
-                            reitr = temp->get_routes().end();
-                    ritr != reitr;
-                    ++ritr
-                    ) {
-                std::set<ib::lid_t>::const_iterator itr = ritr->second.find(target_lid);
-                
-                if (itr != ritr->second.end()) {
-                    const ib::entity_t::portmap_t::const_iterator port_itr = temp->ports.find(ritr->first);
-                    if (port_itr != temp->ports.end()) {
-                        
-                        const ib::port_t *const port = port_itr->second;
-                        const ib::tulip_fabric_t::port_edges_t::const_iterator edge_itr = fabric->port_edges.find(
-                                const_cast<ib::port_t *>(port));
-                        if (edge_itr != fabric->port_edges.end()) {
-                            
-                            const tlp::edge &edge = edge_itr->second;
-                            //setColor->setEdgeValue(edge, tlp::Color::SpringGreen);
-                            selectBool->setEdgeValue(edge, true);
-                            selectBool->setNodeValue(graph->target(edge), true);
-                            const ib::entity_t * node =  getMyEntity(graph->target(edge),fabric);
-                            tmp.push_back(const_cast<ib::entity_t *> (node));
-                            count_hops++;
-                            find_next = true;
-                        }
-                    }
-                }
-            }
-            if(!find_next)
-            break;
-        }
 
-
-        cout<<"The "<<count_hops<<" step: "<<target_entity->guid<<endl;
-        cout<<" ------------------------" <<endl;
-        cout<<"The total hops: "<<count_hops<<endl;
-
-    }
-    
+    cout<<"The "<<count_hops<<" step: "<<forwarding.entity(target)->guid<<endl;
+    cout<<" ------------------------" <<endl;
+    cout<<"The total hops: "<<count_hops<<endl;
 
     if(pluginProgress)
     {
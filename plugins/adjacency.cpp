@@ -0,0 +1,194 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <algorithm>
+#include "adjacency.h"
+
+namespace ib = infiniband;
+
+/**
+ * Static snapshot map to allow reuse between plugin runs
+ */
+ib::adjacency_t::map_t ib::adjacency_t::map = ib::adjacency_t::map_t();
+
+const ib::adjacency_t::index_t ib::adjacency_t::INVALID_INDEX;
+
+namespace
+{
+
+/**
+ * @brief drops the snapshot of a graph as soon as its nodes or edges change
+ *
+ * Registered as a listener (not an observer) so it is notified right
+ * away, even while observers are held during an import.
+ */
+class graph_listener_t : public tlp::Observable
+{
+protected:
+  void treatEvent(const tlp::Event &event)
+  {
+    const tlp::Graph * const graph = dynamic_cast<const tlp::Graph *>(event.sender());
+    if(!graph)
+      return;
+
+    if(event.type() == tlp::Event::TLP_DELETE)
+    {
+      ib::adjacency_t::invalidate(graph);
+      return;
+    }
+
+    const tlp::GraphEvent * const graph_event = dynamic_cast<const tlp::GraphEvent *>(&event);
+    if(!graph_event)
+      return;
+
+    switch(graph_event->getType())
+    {
+      case tlp::GraphEvent::TLP_ADD_NODE:
+      case tlp::GraphEvent::TLP_DEL_NODE:
+      case tlp::GraphEvent::TLP_ADD_EDGE:
+      case tlp::GraphEvent::TLP_DEL_EDGE:
+      case tlp::GraphEvent::TLP_AFTER_SET_ENDS:
+      case tlp::GraphEvent::TLP_ADD_NODES:
+      case tlp::GraphEvent::TLP_ADD_EDGES:
+        ib::adjacency_t::invalidate(graph);
+        break;
+      default:
+        break;
+    }
+  }
+};
+
+graph_listener_t listener;
+
+}
+
+ib::adjacency_t::adjacency_t(const tlp::Graph * const graph)
+  : edge_count(graph->numberOfEdges())
+{
+  assert(graph);
+
+  /**
+   * Remap tulip ids into dense index
+   */
+  const std::vector<tlp::node> &graph_nodes = graph->nodes();
+  nodes.assign(graph_nodes.begin(), graph_nodes.end());
+
+  unsigned int max_id = 0;
+  for(size_t i = 0; i < nodes.size(); ++i)
+    max_id = std::max(max_id, nodes[i].id + 1);
+
+  node_index.assign(max_id, INVALID_INDEX);
+  for(size_t i = 0; i < nodes.size(); ++i)
+    node_index[nodes[i].id] = static_cast<index_t>(i);
+
+  /**
+   * Count degree of each node (both directions) then fill rows
+   */
+  const std::vector<tlp::edge> &graph_edges = graph->edges();
+  offsets.assign(nodes.size() + 1, 0);
+
+  for(size_t i = 0; i < graph_edges.size(); ++i)
+  {
+    const std::pair<tlp::node, tlp::node> &ends = graph->ends(graph_edges[i]);
+    if(ends.first == ends.second)
+      continue;
+
+    ++offsets[index(ends.first) + 1];
+    ++offsets[index(ends.second) + 1];
+  }
+
+  for(size_t i = 1; i < offsets.size(); ++i)
+    offsets[i] += offsets[i - 1];
+
+  targets.resize(offsets.back());
+  std::vector<index_t> fill(offsets.begin(), offsets.end() - 1);
+
+  for(size_t i = 0; i < graph_edges.size(); ++i)
+  {
+    const std::pair<tlp::node, tlp::node> &ends = graph->ends(graph_edges[i]);
+    if(ends.first == ends.second)
+      continue;
+
+    const index_t s = index(ends.first);
+    const index_t t = index(ends.second);
+    targets[fill[s]++] = t;
+    targets[fill[t]++] = s;
+  }
+
+  /**
+   * Every cable is 2 directional edges: sort and dedup each row
+   * then compact the rows in place
+   */
+  index_t write = 0;
+  for(index_t v = 0; v < size(); ++v)
+  {
+    const index_t first = offsets[v];
+    const index_t last = offsets[v + 1];
+    std::sort(targets.begin() + first, targets.begin() + last);
+
+    offsets[v] = write;
+    for(index_t i = first; i < last; ++i)
+      if(i == first || targets[i] != targets[write - 1])
+        targets[write++] = targets[i];
+  }
+  offsets[size()] = write;
+  targets.resize(write);
+  std::vector<index_t>(targets).swap(targets);
+}
+
+bool ib::adjacency_t::is_current(const tlp::Graph * const graph) const
+{
+  return graph->numberOfNodes() == nodes.size() && graph->numberOfEdges() == edge_count;
+}
+
+const ib::adjacency_t &ib::adjacency_t::find(const tlp::Graph * const graph)
+{
+  assert(graph);
+
+  const map_t::iterator itr = map.find(graph);
+  if(itr != map.end())
+  {
+    if(itr->second->is_current(graph))
+      return *itr->second;
+
+    invalidate(graph);
+  }
+
+  ib::adjacency_t * const adjacency = new ib::adjacency_t(graph);
+  assert(adjacency);
+
+  std::pair<map_t::iterator, bool> result = map.insert(std::make_pair(graph, adjacency));
+  assert(result.second);
+
+  graph->addListener(&listener);
+
+  return *result.first->second;
+}
+
+void ib::adjacency_t::invalidate(const tlp::Graph * const graph)
+{
+  const map_t::iterator itr = map.find(graph);
+  if(itr != map.end())
+  {
+    graph->removeListener(&listener);
+
+    delete itr->second;
+    map.erase(itr);
+  }
+}
@@ -0,0 +1,162 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <tulip/TulipPluginHeaders.h>
+
+#ifndef IB_TULIP_ADJACENCY_H
+#define IB_TULIP_ADJACENCY_H
+
+namespace infiniband
+{
+
+/**
+ * @brief Compressed sparse row adjacency snapshot of a tulip graph
+ *
+ * Every path and analysis plugin walks the graph as an undirected graph
+ * with unit weights. Instead of each plugin building its own V x V matrix,
+ * this class remaps the tulip node ids to a dense index [0, V) and stores
+ * the (deduplicated, undirected) neighbors of every node in CSR form.
+ * Memory is O(V+E).
+ *
+ * Snapshots are cached per graph in the same manner as tulip_fabric_t and
+ * are dropped as soon as a node or edge of the graph is added, deleted or
+ * moved (the graph is listened to), or when invalidated by an import.
+ */
+class adjacency_t
+{
+public:
+  typedef uint32_t index_t;
+
+  /**
+   * @brief index returned for nodes not in snapshot
+   */
+  static const index_t INVALID_INDEX = ~static_cast<index_t>(0);
+
+  adjacency_t(const tlp::Graph * const graph);
+
+  /**
+   * @brief number of nodes (V)
+   */
+  index_t size() const { return static_cast<index_t>(nodes.size()); }
+
+  /**
+   * @brief number of stored arcs (2 per undirected neighbor pair)
+   */
+  size_t arcs() const { return targets.size(); }
+
+  /**
+   * @brief get dense index of tulip node
+   * @return dense index or INVALID_INDEX if node is not in snapshot
+   */
+  index_t index(const tlp::node &node) const
+  {
+    return node.id < node_index.size() ? node_index[node.id] : INVALID_INDEX;
+  }
+
+  /**
+   * @brief get tulip node from dense index
+   */
+  const tlp::node &node(const index_t index) const
+  {
+    assert(index < nodes.size());
+    return nodes[index];
+  }
+
+  /**
+   * @brief first neighbor of dense index
+   */
+  const index_t *begin(const index_t index) const
+  {
+    assert(index < nodes.size());
+    return targets.empty() ? NULL : &targets[0] + offsets[index];
+  }
+
+  /**
+   * @brief one past the last neighbor of dense index
+   */
+  const index_t *end(const index_t index) const
+  {
+    assert(index < nodes.size());
+    return targets.empty() ? NULL : &targets[0] + offsets[index + 1];
+  }
+
+  /**
+   * @brief offset of first arc of dense index (used for per arc data)
+   */
+  size_t arc_offset(const index_t index) const { return offsets[index]; }
+
+  /**
+   * @brief check if snapshot still matches size of given graph
+   */
+  bool is_current(const tlp::Graph * const graph) const;
+
+  /**
+   * @brief get (and build if needed) snapshot for given graph
+   * @param graph ptr to tulip graph
+   * @return snapshot for graph
+   */
+  static const adjacency_t &find(const tlp::Graph * const graph);
+
+  /**
+   * @brief drop cached snapshot for given graph
+   * @note called on every change of the graph and by imports
+   */
+  static void invalidate(const tlp::Graph * const graph);
+
+private:
+  /**
+   * @brief tulip node id -> dense index
+   */
+  std::vector<index_t> node_index;
+
+  /**
+   * @brief dense index -> tulip node
+   */
+  std::vector<tlp::node> nodes;
+
+  /**
+   * @brief CSR row offsets (V+1)
+   */
+  std::vector<index_t> offsets;
+
+  /**
+   * @brief CSR column indexes (neighbor dense indexes)
+   */
+  std::vector<index_t> targets;
+
+  /**
+   * @brief edge count when snapshot was made
+   */
+  unsigned int edge_count;
+
+  /**
+   * @brief type for static snapshot map
+   */
+  typedef std::map<const tlp::Graph*, adjacency_t *> map_t;
+  static map_t map;
+};
+
+}
+
+#endif // IB_TULIP_ADJACENCY_H
@@ -0,0 +1,238 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+
+#include <fstream>
+#include <algorithm>
+#include <vector>
+
+#include <tulip/TlpTools.h>
+#include <tulip/Graph.h>
+#include <tulip/BooleanProperty.h>
+#include <tulip/IntegerProperty.h>
+#include <tulip/DoubleProperty.h>
+
+#include "allPairsHops.h"
+#include "paths.h"
+#include "fabric.h"
+
+using namespace tlp;
+using namespace std;
+
+PLUGIN(allPairsHops)
+
+static const char * paramHelp[] = {
+  // File to write
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "pathname" ) \
+  HTML_HELP_DEF( "default", "none" ) \
+  HTML_HELP_BODY() \
+  "Optional path to dump the binary hop matrix to. " \
+  "Format: \"IBHOPMAT\", then uint32 version, bits, rows, columns, " \
+  "the tulip node id of every row and column and finally the rows." \
+  HTML_HELP_CLOSE(),
+
+  // HCA Only
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "bool" ) \
+  HTML_HELP_DEF( "default", "true" ) \
+  HTML_HELP_BODY() \
+  "Only use HCAs (ibHca) as sources and targets. All nodes are used if ibHca is not populated." \
+  HTML_HELP_CLOSE(),
+
+  // Packed
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "bool" ) \
+  HTML_HELP_DEF( "default", "true" ) \
+  HTML_HELP_BODY() \
+  "Store 4 bits per entry (max 14 hops) instead of 8 bits (max 254 hops)." \
+  HTML_HELP_CLOSE(),
+
+  // Threads
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "0" ) \
+  HTML_HELP_BODY() \
+  "Number of threads to use. 0 uses every core." \
+  HTML_HELP_CLOSE()
+};
+
+//Constructor
+allPairsHops::allPairsHops(tlp::PluginContext* context)
+: tlp::Algorithm(context){
+    addInParameter<std::string>("anyfile::filename", paramHelp[0], "", false);
+    addInParameter<bool>("HCA Only", paramHelp[1], "true");
+    addInParameter<bool>("Packed", paramHelp[2], "true");
+    addInParameter<int>("Threads", paramHelp[3], "0");
+}
+
+namespace ib = infiniband;
+
+//Tulip's main function
+bool allPairsHops::run()
+{
+    assert(graph);
+
+    static const size_t STEPS = 4;
+
+    if(pluginProgress)
+    {
+        pluginProgress->showPreview(false);
+        pluginProgress->setComment("Selecting sources");
+        pluginProgress->progress(0, STEPS);
+    }
+
+    std::string filename;
+    bool hcaOnly = true;
+    bool packed = true;
+    int threads = 0;
+
+    if(dataSet)
+    {
+        dataSet->get("anyfile::filename", filename);
+        dataSet->get("HCA Only", hcaOnly);
+        dataSet->get("Packed", packed);
+        dataSet->get("Threads", threads);
+    }
+
+    //Sources and targets are the same set of nodes
+    IntegerProperty *ibHca = NULL;
+    ib::tulip_fabric_t * const fabric = hcaOnly ? ib::tulip_fabric_t::find_fabric(graph, false) : NULL;
+    if(fabric)
+        fabric->require_field("ibHca");
+
+    if(hcaOnly && graph->existProperty("ibHca"))
+        ibHca = graph->getProperty<IntegerProperty>("ibHca");
+
+    //Snapshot only after the fabric is loaded: a deferred load changes the graph
+    const ib::adjacency_t &adjacency = ib::adjacency_t::find(graph);
+
+    std::vector<ib::adjacency_t::index_t> endpoints;
+    for(ib::adjacency_t::index_t i = 0; i<adjacency.size(); i++){
+        if(!ibHca || ibHca->getNodeValue(adjacency.node(i)))
+            endpoints.push_back(i);
+    }
+
+    if(endpoints.empty())
+    {
+      if(pluginProgress)
+        pluginProgress->setError("No nodes to compute hops between");
+
+      return false;
+    }
+
+    if(pluginProgress)
+    {
+        pluginProgress->setComment("Running bit-parallel BFS from every source...");
+        pluginProgress->progress(1, STEPS);
+    }
+
+    ib::hop_matrix_t matrix(endpoints.size(), endpoints.size(), packed ? 4 : 8);
+    ib::all_pairs_hops(adjacency, endpoints, endpoints, matrix, threads > 0 ? threads : 0);
+
+    if(pluginProgress)
+    {
+        pluginProgress->setComment("Storing hop statistics");
+        pluginProgress->progress(2, STEPS);
+    }
+
+    //Per node max and mean hops to every reachable endpoint
+    IntegerProperty *ibHopMax = graph->getProperty<IntegerProperty>("ibHopMax");
+    DoubleProperty *ibHopMean = graph->getProperty<DoubleProperty>("ibHopMean");
+    assert(ibHopMax);
+    assert(ibHopMean);
+
+    for(ib::adjacency_t::index_t row = 0; row<matrix.rows(); row++){
+        unsigned int max = 0, count = 0;
+        double sum = 0;
+        for(ib::adjacency_t::index_t column = 0; column<matrix.columns(); column++){
+            const uint8_t hops = matrix.get(row, column);
+            if(hops == matrix.unreachable())
+                continue;
+
+            max = std::max<unsigned int>(max, hops);
+            sum += hops;
+            count++;
+        }
+
+        const tlp::node &node = adjacency.node(endpoints[row]);
+        ibHopMax->setNodeValue(node, max);
+        ibHopMean->setNodeValue(node, count ? sum / count : 0);
+    }
+
+    //Same output as Dijkstra for a single selected endpoint
+    BooleanProperty *selectBool = graph->getLocalProperty<BooleanProperty>("viewSelection");
+    tlp::Iterator<node> *selections = selectBool->getNodesEqualTo(true,NULL);
+    if(selections->hasNext()){
+        const ib::adjacency_t::index_t selected = adjacency.index(selections->next());
+        const std::vector<ib::adjacency_t::index_t>::const_iterator itr = std::find(endpoints.begin(), endpoints.end(), selected);
+
+        if(!selections->hasNext() && itr != endpoints.end()){
+            tlp::IntegerProperty * ibHop = graph->getProperty<tlp::IntegerProperty>("ibHop");
+            assert(ibHop);
+
+            const ib::adjacency_t::index_t row = itr - endpoints.begin();
+            for(ib::adjacency_t::index_t column = 0; column<matrix.columns(); column++){
+                const uint8_t hops = matrix.get(row, column);
+                ibHop->setNodeValue(adjacency.node(endpoints[column]), hops == matrix.unreachable() ? INT_MAX : hops);
+            }
+        }
+    }
+    delete selections;
+
+    if(pluginProgress)
+    {
+        pluginProgress->setComment("Writing hop matrix");
+        pluginProgress->progress(3, STEPS);
+    }
+
+    if(!filename.empty())
+    {
+        std::ofstream ofs(filename.c_str(), std::ios::binary);
+        if(!ofs)
+        {
+          if(pluginProgress)
+            pluginProgress->setError("Unable open output file.");
+
+          return false;
+        }
+
+        const uint32_t header[] = { 1, matrix.bits(), matrix.rows(), matrix.columns() };
+        ofs.write("IBHOPMAT", 8);
+        ofs.write(reinterpret_cast<const char *>(header), sizeof(header));
+
+        //rows and columns are the same endpoints
+        std::vector<uint32_t> ids;
+        for(size_t i = 0; i<endpoints.size(); i++)
+            ids.push_back(adjacency.node(endpoints[i]).id);
+        ofs.write(reinterpret_cast<const char *>(&ids[0]), ids.size() * sizeof(uint32_t));
+        ofs.write(reinterpret_cast<const char *>(&ids[0]), ids.size() * sizeof(uint32_t));
+
+        for(ib::adjacency_t::index_t row = 0; row<matrix.rows(); row++)
+            ofs.write(reinterpret_cast<const char *>(matrix.row(row)), matrix.row_bytes());
+    }
+
+    if(pluginProgress)
+    {
+        pluginProgress->setComment("All Pairs Hops Finished");
+        pluginProgress->progress(STEPS, STEPS);
+    }
+
+    return true;
+}
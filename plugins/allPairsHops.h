@@ -0,0 +1,44 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+
+
+#include <tulip/TulipPluginHeaders.h>
+#include <tulip/TlpTools.h>
+#include <tulip/Graph.h>
+
+#ifndef ALL_PAIRS_HOPS_H
+#define ALL_PAIRS_HOPS_H
+
+class allPairsHops: public tlp::Algorithm{
+public:
+    PLUGININFORMATION("All Pairs Hops",
+    "NCAR",
+    "10/17/26",
+    "Computes the hop count matrix between all (HCA) nodes with a bit-parallel BFS. Stores the hops from the selected node in ibHop and per node max/mean hops.",
+    "alpha",
+    "Infiniband")
+
+//Constructor
+    allPairsHops(tlp::PluginContext* context);
+
+//Main function for tulip
+    bool run();
+};
+#endif //ALL_PAIRS_HOPS_H
@@ -0,0 +1,324 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <tulip/IntegerProperty.h>
+#include "batchRoutes.h"
+#include "fabric.h"
+#include "forwarding.h"
+#include "input_stream.h"
+#include "ibautils/ib_fabric.h"
+
+PLUGIN(BatchRouteTrace)
+
+static const char * paramHelp[] = {
+  // File to Open
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "pathname" ) \
+  HTML_HELP_BODY() \
+  "Path to ibdiagnet2.fdbs file to import (plain, gzip or zstd)" \
+  HTML_HELP_CLOSE(),
+
+  // Pairs to trace
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "pathname" ) \
+  HTML_HELP_BODY() \
+  "CSV (plain, gzip or zstd) with a source and destination per line. Endpoints are hex GUIDs (0x...), node names or hostnames." \
+  HTML_HELP_CLOSE(),
+
+  // Output
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "pathname" ) \
+  HTML_HELP_DEF( "default", "none" ) \
+  HTML_HELP_BODY() \
+  "Optional CSV to write source,destination,hops of every pair to. Pairs without a route have -1 hops." \
+  HTML_HELP_CLOSE(),
+
+  // Threads
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "0" ) \
+  HTML_HELP_BODY() \
+  "Number of threads to use. 0 uses every core." \
+  HTML_HELP_CLOSE()
+};
+
+BatchRouteTrace::BatchRouteTrace(tlp::PluginContext* context)
+  : tlp::Algorithm(context)
+{
+  addInParameter<std::string>("file::filename", paramHelp[0],"");
+  addInParameter<std::string>("file::pairs", paramHelp[1],"");
+  addInParameter<std::string>("anyfile::output", paramHelp[2],"", false);
+  addInParameter<int>("Threads", paramHelp[3],"0");
+}
+
+namespace ib = infiniband;
+
+namespace
+{
+
+/**
+ * @brief source and destination names and indexes of a line
+ */
+struct pair_t
+{
+  std::string source_name;
+  std::string destination_name;
+  ib::forwarding_t::index_t source;
+  ib::forwarding_t::index_t destination;
+};
+
+}
+
+bool BatchRouteTrace::run()
+{
+  assert(graph);
+
+  static const size_t STEPS = 5;
+  if(pluginProgress)
+  {
+    pluginProgress->showPreview(false);
+    pluginProgress->setComment("Starting Batch Route Trace");
+    pluginProgress->progress(0, STEPS);
+  }
+
+  ib::tulip_fabric_t * const fabric = ib::tulip_fabric_t::find_fabric(graph, false);
+  if(!fabric)
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable find fabric. Make sure to preserve data when importing data.");
+
+    return false;
+  }
+
+  std::string filename;
+  std::string pairs_filename;
+  std::string output_filename;
+  int threads = 0;
+
+  dataSet->get("file::filename", filename);
+  dataSet->get("file::pairs", pairs_filename);
+  dataSet->get("anyfile::output", output_filename);
+  dataSet->get("Threads", threads);
+
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Parsing Routes.");
+    pluginProgress->progress(1, STEPS);
+  }
+
+  if(!fabric->load_routes(filename))
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable open or parse routes file.");
+
+    return false;
+  }
+
+  const ib::forwarding_t &forwarding = fabric->get_forwarding();
+
+  /**
+   * read and resolve every pair
+   */
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Reading pairs.");
+    pluginProgress->progress(2, STEPS);
+  }
+
+  ///plain, gzip or zstd
+  ib::input_stream_t input;
+  if(!input.open(pairs_filename))
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable open pairs file.");
+
+    return false;
+  }
+  std::istream is(&input);
+
+  const ib::endpoints_t endpoints(forwarding);
+  std::vector<pair_t> pairs;
+  size_t unknown = 0;
+
+  std::string line;
+  while(std::getline(is, line))
+  {
+    const std::string::size_type comma = line.find(',');
+    if(comma == std::string::npos || line[0] == '#')
+      continue;
+
+    pair_t pair;
+    pair.source_name = line.substr(0, comma);
+    pair.destination_name = line.substr(comma + 1, line.find(',', comma + 1) - comma - 1);
+    pair.source = endpoints.find(pair.source_name);
+    pair.destination = endpoints.find(pair.destination_name);
+
+    if(pair.source == ib::forwarding_t::INVALID_INDEX || pair.destination == ib::forwarding_t::INVALID_INDEX)
+    {
+      ///header or unknown endpoint
+#ifndef NDEBUG
+      std::cerr << "unknown pair: " << line << std::endl;
+#endif
+      ++unknown;
+      continue;
+    }
+
+    pairs.push_back(pair);
+  }
+  input.close();
+
+  if(input.failed())
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Compressed pairs file is truncated or corrupt.");
+
+    return false;
+  }
+
+  if(pairs.empty())
+  {
+    if(pluginProgress)
+      pluginProgress->setError("No known pairs found in pairs file.");
+
+    return false;
+  }
+
+  /**
+   * trace every pair, each thread counts traversals
+   * into its own array which are summed afterwards
+   */
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Tracing routes.");
+    pluginProgress->progress(3, STEPS);
+  }
+
+  size_t edge_count = 0;
+  for(
+    ib::tulip_fabric_t::port_edges_t::const_iterator
+    itr = fabric->port_edges.begin(),
+    eitr = fabric->port_edges.end();
+    itr != eitr;
+    ++itr
+  )
+    edge_count = std::max<size_t>(edge_count, itr->second.id + 1);
+
+  unsigned int thread_count = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+  thread_count = std::min<size_t>(thread_count, pairs.size());
+
+  std::vector<int> hops(pairs.size(), ib::forwarding_t::NO_ROUTE);
+  std::vector<std::vector<unsigned int> > traversals(thread_count);
+  std::vector<std::thread> pool;
+
+  const size_t chunk = (pairs.size() + thread_count - 1) / thread_count;
+  for(unsigned int t = 0; t < thread_count; ++t)
+  {
+    const size_t first = std::min(pairs.size(), t * chunk);
+    const size_t last = std::min(pairs.size(), first + chunk);
+
+    pool.push_back(std::thread([&, t, first, last]()
+    {
+      std::vector<unsigned int> &counts = traversals[t];
+      counts.assign(edge_count, 0);
+
+      std::vector<tlp::edge> edges;
+      for(size_t i = first; i < last; ++i)
+      {
+        edges.clear();
+        hops[i] = forwarding.trace(pairs[i].source, pairs[i].destination, edges);
+        if(hops[i] == ib::forwarding_t::NO_ROUTE)
+          continue;
+
+        for(size_t e = 0; e < edges.size(); ++e)
+          if(edges[e].id < edge_count)
+            ++counts[edges[e].id];
+      }
+    }));
+  }
+
+  for(size_t t = 0; t < pool.size(); ++t)
+    pool[t].join();
+
+  for(size_t t = 1; t < traversals.size(); ++t)
+    for(size_t e = 0; e < edge_count; ++e)
+      traversals[0][e] += traversals[t][e];
+
+  /**
+   * store results
+   */
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Storing route traversals.");
+    pluginProgress->progress(4, STEPS);
+  }
+
+  tlp::IntegerProperty * ibRouteTraversals = graph->getProperty<tlp::IntegerProperty>("ibRouteTraversals");
+  tlp::IntegerProperty * ibRouteHopsMax = graph->getProperty<tlp::IntegerProperty>("ibRouteHopsMax");
+  assert(ibRouteTraversals);
+  assert(ibRouteHopsMax);
+
+  ibRouteTraversals->setAllEdgeValue(0);
+  for(
+    ib::tulip_fabric_t::port_edges_t::const_iterator
+    itr = fabric->port_edges.begin(),
+    eitr = fabric->port_edges.end();
+    itr != eitr;
+    ++itr
+  )
+    ibRouteTraversals->setEdgeValue(itr->second, traversals[0][itr->second.id]);
+
+  std::vector<int> hops_max(forwarding.size(), ib::forwarding_t::NO_ROUTE);
+  for(size_t i = 0; i < pairs.size(); ++i)
+    hops_max[pairs[i].source] = std::max(hops_max[pairs[i].source], hops[i]);
+
+  ibRouteHopsMax->setAllNodeValue(ib::forwarding_t::NO_ROUTE);
+  for(ib::forwarding_t::index_t i = 0; i < forwarding.size(); ++i)
+    ibRouteHopsMax->setNodeValue(forwarding.node(i), hops_max[i]);
+
+  if(!output_filename.empty())
+  {
+    std::ofstream ofs(output_filename.c_str());
+    if(!ofs)
+    {
+      if(pluginProgress)
+        pluginProgress->setError("Unable open output file.");
+
+      return false;
+    }
+
+    ofs << "source,destination,hops\n";
+    for(size_t i = 0; i < pairs.size(); ++i)
+      ofs << pairs[i].source_name << ',' << pairs[i].destination_name << ',' << hops[i] << '\n';
+  }
+
+  if(pluginProgress)
+  {
+    std::stringstream comment;
+    comment << "Traced " << pairs.size() << " pairs, skipped " << unknown << " unknown lines.";
+    pluginProgress->setComment(comment.str());
+    pluginProgress->progress(STEPS, STEPS);
+  }
+
+  return true;
+}
@@ -0,0 +1,51 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <tulip/TulipPluginHeaders.h>
+
+#ifndef IB_BATCH_ROUTES_H
+#define IB_BATCH_ROUTES_H
+
+/**
+ * @brief Trace routes between lists of endpoint pairs
+ *
+ * Reads (source, destination) pairs from a CSV and follows the LFTs of
+ * every pair in parallel. Uses the routes and fabric retained on the
+ * graph by earlier imports.
+ */
+class BatchRouteTrace: public tlp::Algorithm {
+public:
+  PLUGININFORMATION("Infiniband Batch Route Trace",
+                    "NCAR",
+                    "10/17/26",
+                    "Trace routes of every (source, destination) pair in a CSV. Stores traversals per edge in ibRouteTraversals and the longest route per source in ibRouteHopsMax.",
+                    "alpha",
+                    "Infiniband")
+
+  BatchRouteTrace(tlp::PluginContext* context);
+
+  /**
+   * @brief trace every pair in the CSV
+   */
+  bool run();
+};
+
+#endif // IB_BATCH_ROUTES_H
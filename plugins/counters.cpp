@@ -0,0 +1,69 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include "counters.h"
+
+namespace ib = infiniband;
+
+bool ib::counter_history_t::update(
+  const tlp::edge &edge,
+  const uint64_t value,
+  const uint64_t time,
+  const unsigned int width,
+  uint64_t &delta,
+  double &seconds
+)
+{
+  if(edge.id >= samples.size())
+  {
+    const counter_sample_t none = { 0, 0, false };
+    samples.resize(edge.id + 1, none);
+  }
+
+  counter_sample_t &sample = samples[edge.id];
+  const counter_sample_t previous = sample;
+
+  sample.value = value;
+  sample.time = time;
+  sample.valid = true;
+
+  if(!previous.valid)
+    return false;
+
+  const uint64_t mask = width && width < 64 ? (static_cast<uint64_t>(1) << width) - 1 : ~static_cast<uint64_t>(0);
+  if(value >= previous.value)
+    delta = value - previous.value;
+  else
+  {
+    /**
+     * a decrease is a wrap at 2^width only if the wrapped delta is
+     * plausible (less than half the range): anything else, and every
+     * decrease of a 64 bit counter, is a reset (perfquery -R, reboot,
+     * port flap) and the counter counted up from 0 since
+     */
+    const uint64_t wrapped = (value - previous.value) & mask;
+    delta = mask != ~static_cast<uint64_t>(0) && wrapped <= mask / 2 ? wrapped : value;
+  }
+
+  seconds = 0;
+  if(time && previous.time && time > previous.time)
+    seconds = static_cast<double>(time - previous.time) / 1e9;
+
+  return true;
+}
@@ -0,0 +1,96 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <tulip/Edge.h>
+
+#ifndef IB_TULIP_COUNTERS_H
+#define IB_TULIP_COUNTERS_H
+
+namespace infiniband
+{
+
+/**
+ * @brief value of a cumulative counter at a point in time
+ */
+struct counter_sample_t
+{
+  uint64_t value;
+  uint64_t time; ///nanoseconds since epoch, 0 if unknown
+  bool valid;
+};
+
+/**
+ * @brief Previous snapshot of a cumulative port counter
+ *
+ * Keeps the last sample of every edge so consecutive CSV imports
+ * can be turned into deltas and rates.
+ */
+class counter_history_t
+{
+public:
+  /**
+   * @brief record sample of edge and get change since previous sample
+   * @param edge edge of port
+   * @param value raw counter value
+   * @param time nanoseconds since epoch or 0 if unknown
+   * @param width counter width in bits, counter wraps at 2^width
+   *   (a decrease that is not a plausible wrap is taken as a reset)
+   * @param delta change since previous sample
+   * @param seconds time since previous sample or 0 if unknown
+   * @return false if edge has no previous sample
+   */
+  bool update(
+    const tlp::edge &edge,
+    const uint64_t value,
+    const uint64_t time,
+    const unsigned int width,
+    uint64_t &delta,
+    double &seconds
+  );
+
+  /**
+   * @brief forget every sample
+   */
+  void clear() { samples.clear(); }
+
+  void swap(counter_history_t &other) { samples.swap(other.samples); }
+
+  /**
+   * @brief forget sample of a deleted edge (Tulip reuses edge ids)
+   */
+  void forget(const tlp::edge &edge)
+  {
+    if(edge.id < samples.size())
+      samples[edge.id].valid = false;
+  }
+
+private:
+  /**
+   * @brief last sample indexed by edge.id
+   */
+  std::vector<counter_sample_t> samples;
+};
+
+}
+
+#endif // IB_TULIP_COUNTERS_H
@@ -19,9 +19,19 @@
  */
 
 #include<fstream>
-#include <tulip/CSVParser.h>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <QCoreApplication>
+#include <QObject>
+#include <QTimerEvent>
+#include <tulip/DoubleProperty.h>
 #include "csv.h"
+#include "csv_reader.h"
+#include "csv_tail.h"
 #include "fabric.h"
+#include "progress.h"
 #include "ibautils/ib_fabric.h"
 #include "ibautils/regex.h"
 
@@ -32,7 +42,7 @@ static const char * paramHelp[] = {
   HTML_HELP_OPEN() \
   HTML_HELP_DEF( "type", "pathname" ) \
   HTML_HELP_BODY() \
-  "Path to ibdiagnet2.fdbs file to import" \
+  "Path to CSV file to import (plain, gzip or zstd)" \
   HTML_HELP_CLOSE(),
 
   // Guid Column
@@ -64,7 +74,71 @@ static const char * paramHelp[] = {
   HTML_HELP_DEF( "type", "string" ) \
   HTML_HELP_DEF( "default", "ibMetric" ) \
   HTML_HELP_BODY() \
-  "Field name to assign data to from CSV." \
+  "Field name to assign data to from CSV (a double property, the exact 64 bit value goes to the string field <field>Raw)." \
+  HTML_HELP_CLOSE(),
+
+  // data columns
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "string" ) \
+  HTML_HELP_DEF( "default", "" ) \
+  HTML_HELP_BODY() \
+  "Comma separated list of column:field pairs (e.g. 4:ibXmitData,5:ibRcvData) imported in a single pass. Overrides Data Column and Data Name when set." \
+  HTML_HELP_CLOSE(),
+
+  // timestamp column
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "0" ) \
+  HTML_HELP_BODY() \
+  "Column number containing nanoseconds since epoch. 0 if there is no timestamp." \
+  HTML_HELP_CLOSE(),
+
+  // counter deltas
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "bool" ) \
+  HTML_HELP_DEF( "default", "false" ) \
+  HTML_HELP_BODY() \
+  "Treat data as cumulative counters. Every field also gets a <field>Delta with the change since the previous import of the same field and, with a timestamp column, a <field>Rate per second." \
+  HTML_HELP_CLOSE(),
+
+  // counter width
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "64" ) \
+  HTML_HELP_BODY() \
+  "Width in bits of the counters. A counter smaller than the previous sample wrapped at 2^width if that gives a delta below 2^(width-1), otherwise (and always for 64 bit counters) it was reset and its value is the delta." \
+  HTML_HELP_CLOSE(),
+
+  // history samples
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "0" ) \
+  HTML_HELP_BODY() \
+  "Number of imports to retain per field for Infiniband Metric History (0 disables). Counter fields retain their rate, or delta without timestamp column. While following, every batch interval with new rows is one import." \
+  HTML_HELP_CLOSE(),
+
+  // follow
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "bool" ) \
+  HTML_HELP_DEF( "default", "false" ) \
+  HTML_HELP_BODY() \
+  "Keep reading rows appended to the file (or written to a FIFO or Unix socket). In the GUI rows are applied in the background every Batch Interval until Follow Seconds pass, the source closes or the file is imported again. Files resume after the rows applied by the previous import." \
+  HTML_HELP_CLOSE(),
+
+  // batch interval
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "250" ) \
+  HTML_HELP_BODY() \
+  "Milliseconds of rows applied together while following. Observers are notified once per batch." \
+  HTML_HELP_CLOSE(),
+
+  // follow seconds
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "0" ) \
+  HTML_HELP_BODY() \
+  "Seconds to follow, 0 to follow until stopped. Required when run without a progress object, such as from a script." \
   HTML_HELP_CLOSE()
 
 };
@@ -77,132 +151,628 @@ ImportInfinibandCSV::ImportInfinibandCSV(tlp::PluginContext* context)
   addInParameter<int>("Portnum Column", paramHelp[2],"2");
   addInParameter<int>("Data Column", paramHelp[3],"4");
   addInParameter<std::string>("Data Name", paramHelp[4],"ibMetric");
+  addInParameter<std::string>("Data Columns", paramHelp[5],"", false);
+  addInParameter<int>("Timestamp Column", paramHelp[6],"0");
+  addInParameter<bool>("Counter Deltas", paramHelp[7],"false");
+  addInParameter<int>("Counter Width", paramHelp[8],"64");
+  addInParameter<int>("History Samples", paramHelp[9],"0");
+  addInParameter<bool>("Follow", paramHelp[10],"false");
+  addInParameter<int>("Batch Interval", paramHelp[11],"250");
+  addInParameter<int>("Follow Seconds", paramHelp[12],"0");
 }
 
 namespace ib = infiniband;
+
 /**
- * todo: tulip lacks a int64 property currently
+ * @brief CSV column imported into a property
+ *
+ * Metrics are doubles so they can drive mappings and numeric
+ * algorithms, the exact 64 bit raw counter is kept next to them as
+ * decimal text (TLP files only know the built-in property types).
  */
-typedef tlp::DoubleProperty MetricProperty;
+struct column_t
+{
+  uint column;
+  std::string name;
+  tlp::DoubleProperty * metrics;
+  tlp::StringProperty * raws;
+
+  /**
+   * only set when importing counter deltas
+   */
+  ib::counter_history_t * history;
+  tlp::DoubleProperty * deltas;
+  tlp::DoubleProperty * rates;
+
+  /**
+   * only set when keeping history
+   */
+  ib::metric_series_t * series;
+};
+typedef std::vector<column_t> columns_t;
 
 /**
- * @brief Interface to inherit to get and treat data from csv files with CSVParser object.
+ * @brief parse list of column:field pairs
+ * @param list comma separated pairs
+ * @return false if any pair is malformed
  */
-class handler_t : public tlp::CSVContentHandler {
+static bool parse_columns(const std::string &list, columns_t &columns)
+{
+  std::string::size_type pos = 0;
+  while(pos <= list.size())
+  {
+    std::string::size_type end = list.find(',', pos);
+    if(end == std::string::npos)
+      end = list.size();
+
+    const std::string pair = list.substr(pos, end - pos);
+    pos = end + 1;
+
+    const std::string::size_type first = pair.find_first_not_of(" \t");
+    if(first == std::string::npos)
+      continue; ///allow empty entries
+
+    const std::string::size_type colon = pair.find(':', first);
+    if(colon == std::string::npos || colon == first)
+      return false;
+
+    std::string::size_type last = pair.find_last_not_of(" \t", colon - 1);
+    uint64_t column = 0;
+    if(
+      !ib::parse_uint(pair.data() + first, last - first + 1, column) ||
+      !column || column > static_cast<uint>(~0)
+    )
+      return false;
+
+    const std::string::size_type name_first = pair.find_first_not_of(" \t", colon + 1);
+    if(name_first == std::string::npos)
+      return false;
+    last = pair.find_last_not_of(" \t");
+
+    const column_t entry = { static_cast<uint>(column), pair.substr(name_first, last - name_first + 1), NULL, NULL, NULL, NULL, NULL, NULL };
+    columns.push_back(entry);
+  }
+
+  return !columns.empty();
+}
+
+/**
+ * @brief Assign metrics of every CSV line to the edge of its port
+ */
+class handler_t {
 public:
   const uint guid_column;
   const uint portnum_column;
-  const uint data_column;
-  MetricProperty * const metrics;
+  const uint timestamp_column;
+  const uint counter_width;
+  const columns_t &columns;
   ib::tulip_fabric_t * const  fabric;
 
+  ///newest timestamp seen
+  uint64_t latest;
+
   handler_t(
     const uint _guid_column,
     const uint _portnum_column,
-    const uint _data_column,
-    MetricProperty * const _metrics,
+    const uint _timestamp_column,
+    const uint _counter_width,
+    const columns_t &_columns,
       ib::tulip_fabric_t * const _fabric
   ) :
     guid_column(_guid_column),
     portnum_column(_portnum_column),
-    data_column(_data_column),
-    metrics(_metrics),
-    fabric(_fabric)
+    timestamp_column(_timestamp_column),
+    counter_width(_counter_width),
+    columns(_columns),
+    fabric(_fabric),
+    latest(0)
   {
     assert(fabric);
-    assert(metrics);
-  }
-
-  /**
-   * Function called at the beginning of the file parsing.
-   */
-  virtual bool begin()
-  {
-    return true;
+    assert(!columns.empty());
   }
 
   /**
    * Function called for each line in the file.
-   * @param row The number of the row.
-   * @param lineTokens The tokens.
+   * @param lineTokens The tokens (pointing into the mapped file).
+   * @return false if the line is not a known port with at least one metric
    * @example guid,port,time_interval(ns),bytes,nanoseconds since epoch
    */
-  virtual bool line(unsigned int row, const std::vector<std::string>& lineTokens)
+  bool line(const std::vector<ib::token_t>& lineTokens)
   {
-    //std::cout << "read: " << row << ": " << lineTokens.size() << std::endl;
-    //for(std::vector<std::string>::const_iterator itr = lineTokens.begin(), eitr = lineTokens.end(); itr != eitr; ++itr)
-    //  std::cout << "\tread item: " << *itr << std::endl;
-
     const size_t var_count = lineTokens.size();
 
     if(
        ///make sure the field is actually there
        var_count < guid_column      ||
        var_count < portnum_column   ||
-       var_count < data_column      ||
        !( ///column starts at 1
          guid_column > 0  &&
-         portnum_column > 0 &&
-         data_column > 0
+         portnum_column > 0
        )
     )
       return false;
 
-    ib::guid_t guid     = regex::uint_cast_hex_string<ib::guid_t>(lineTokens.at(guid_column - 1));
-    ib::port_num_t portnum = regex::uint_cast_string<ib::port_num_t>(lineTokens.at(portnum_column - 1));
-    int64_t metric = regex::int_cast_string<int64_t >(lineTokens.at(data_column - 1));
-
-#ifndef NDEBUG
-    std::cout << "guid: " << regex::string_cast_uint(guid) <<
-      " port: " << regex::string_cast_uint(portnum) <<
-      " metric: " << regex::string_cast_uint(metric) << std::endl;
-#endif
+    uint64_t guid = 0, portnum = 0;
+    if(
+      !ib::parse_hex(lineTokens[guid_column - 1], guid) ||
+      !ib::parse_uint(lineTokens[portnum_column - 1], portnum) ||
+      portnum > static_cast<ib::port_num_t>(~0)
+    )
+      return false; ///header or malformed line
 
-    const ib::tulip_fabric_t::portmap_guidport_t::const_iterator p_itr = fabric->get_portmap().find(ib::port_t::key_guid_port_t(guid, portnum));
-    if(p_itr == fabric->get_portmap().end())
+    const ib::tulip_fabric_t::port_slot_t * const slot = fabric->find_port_edge(guid, static_cast<ib::port_num_t>(portnum));
+    if(!slot)
     {
-      ///Unknown port?
+      ///Unknown port or port without cable?
 #ifndef NDEBUG
       std::cerr << "unknown guid: " << regex::string_cast_uint(guid) <<
-        " port: " << regex::string_cast_uint(portnum) <<
-        " metric: " << regex::string_cast_uint(metric) << std::endl;
+        " port: " << regex::string_cast_uint(portnum) << std::endl;
 #endif
       return false;
     }
 
-    assert(p_itr->second);
-    const ib::port_t * const port = p_itr->second;
+    assert(slot->port);
+
+    ///nanoseconds since epoch, 0 if unknown
+    uint64_t timestamp = 0;
+    if(
+      timestamp_column &&
+      (var_count < timestamp_column || !ib::parse_uint(lineTokens[timestamp_column - 1], timestamp))
+    )
+      timestamp = 0;
 
-    ib::tulip_fabric_t::port_edges_t::iterator e_itr = fabric->port_edges.find(const_cast<ib::port_t * const>(port));
-    if(e_itr == fabric->port_edges.end())
+    /**
+     * every mapped column of the row, a missing or
+     * malformed value only skips that column
+     */
+    bool found = false;
+    for(columns_t::const_iterator itr = columns.begin(); itr != columns.end(); ++itr)
     {
-      ///Unknown edge for known port?
+      uint64_t metric = 0;
+      if(var_count < itr->column || !ib::parse_uint(lineTokens[itr->column - 1], metric))
+        continue;
+
 #ifndef NDEBUG
-      std::cerr << "unknown edge for known port: guid: " << regex::string_cast_uint(guid) <<
+      std::cout << "guid: " << regex::string_cast_uint(guid) <<
         " port: " << regex::string_cast_uint(portnum) <<
-        " metric: " << regex::string_cast_uint(metric) << std::endl;
+        " " << itr->name << ": " << regex::string_cast_uint(metric) << std::endl;
 #endif
+
+      itr->metrics->setEdgeValue(slot->edge, static_cast<double>(metric));
+      itr->raws->setEdgeValue(slot->edge, regex::string_cast_uint(metric));
+      found = true;
+
+      if(!itr->history)
+      {
+        if(itr->series)
+          itr->series->set(slot->edge, static_cast<double>(metric));
+
+        continue;
+      }
+
+      uint64_t delta = 0;
+      double seconds = 0;
+      if(!itr->history->update(slot->edge, metric, timestamp, counter_width, delta, seconds))
+        continue; ///first sample of port
+
+      itr->deltas->setEdgeValue(slot->edge, static_cast<double>(delta));
+
+      ///never leave the rate of an earlier sample in place
+      itr->rates->setEdgeValue(slot->edge, seconds > 0 ? static_cast<double>(delta) / seconds : std::numeric_limits<double>::quiet_NaN());
+
+      ///history of counters holds rates, or deltas without timestamps
+      if(itr->series && (seconds > 0 || !timestamp_column))
+        itr->series->set(slot->edge, seconds > 0 ? static_cast<double>(delta) / seconds : static_cast<double>(delta));
+    }
+
+    if(timestamp > latest)
+      latest = timestamp;
+
+    return found;
+  }
+};
+
+/**
+ * @brief start new history snapshot of every column
+ */
+static void push_history(const columns_t &columns)
+{
+  for(columns_t::const_iterator itr = columns.begin(); itr != columns.end(); ++itr)
+    if(itr->series)
+      itr->series->push();
+}
+
+/**
+ * @brief set time of newest history snapshot of every column
+ */
+static void time_history(const columns_t &columns, const uint64_t time)
+{
+  for(columns_t::const_iterator itr = columns.begin(); itr != columns.end(); ++itr)
+    if(itr->series)
+      itr->series->set_time(time);
+}
+
+/**
+ * @brief counter history and metric series of an import, to roll back when it fails
+ *
+ * Tulip undoes the graph changes of a failed import, but not the
+ * previous samples and snapshots kept in the fabric between imports.
+ */
+class rollback_t
+{
+public:
+  /**
+   * @brief save counter history of every column, call before the snapshot is pushed
+   */
+  rollback_t(const columns_t &_columns) : columns(_columns)
+  {
+    for(columns_t::const_iterator itr = columns.begin(); itr != columns.end(); ++itr)
+      if(itr->history)
+        histories.push_back(*itr->history);
+  }
+
+  /**
+   * @brief restore counter history and drop the pushed snapshot
+   */
+  void restore()
+  {
+    std::vector<ib::counter_history_t>::iterator history = histories.begin();
+    for(columns_t::const_iterator itr = columns.begin(); itr != columns.end(); ++itr)
+    {
+      if(itr->history)
+        itr->history->swap(*history++);
+
+      if(itr->series)
+        itr->series->undo_push();
+    }
+  }
+
+private:
+  const columns_t &columns;
+  std::vector<ib::counter_history_t> histories;
+};
+
+/**
+ * @brief get properties, counter history and metric series of every column
+ *
+ * History is preallocated for every edge of the fabric, only
+ * reset when its capacity changes and grown for new edges.
+ *
+ * @param conflict set to the field of another type on failure
+ * @return false if a field already exists with another type
+ */
+static bool bind_columns(
+  tlp::Graph * const graph,
+  ib::tulip_fabric_t * const fabric,
+  const bool counter_deltas,
+  const int history_samples,
+  columns_t &columns,
+  std::string &conflict
+)
+{
+  for(columns_t::iterator itr = columns.begin(); itr != columns.end(); ++itr)
+  {
+    ///never cast a field of another type
+    itr->metrics = ib::get_typed_property<tlp::DoubleProperty>(graph, itr->name);
+    itr->raws = ib::get_typed_property<tlp::StringProperty>(graph, itr->name + "Raw");
+
+    /**
+     * previous snapshot is kept in the fabric
+     * between imports of the same field
+     */
+    if(counter_deltas)
+    {
+      itr->history = &fabric->counters[itr->name];
+      itr->deltas = ib::get_typed_property<tlp::DoubleProperty>(graph, itr->name + "Delta");
+      itr->rates = ib::get_typed_property<tlp::DoubleProperty>(graph, itr->name + "Rate");
+    }
+
+    if(!itr->metrics || !itr->raws || (counter_deltas && (!itr->deltas || !itr->rates)))
+    {
+      conflict = itr->name;
       return false;
     }
+  }
+
+  if(history_samples)
+  {
+    size_t edges = 0;
+    for(
+      ib::tulip_fabric_t::port_edges_t::const_iterator
+        itr = fabric->port_edges.begin(),
+        eitr = fabric->port_edges.end();
+      itr != eitr;
+      ++itr
+    )
+      edges = std::max<size_t>(edges, itr->second.id + 1);
 
-    tlp::edge &edge = e_itr->second;
+    for(columns_t::iterator itr = columns.begin(); itr != columns.end(); ++itr)
+    {
+      itr->series = &fabric->series[itr->name];
+      if(itr->series->get_capacity() != static_cast<size_t>(history_samples))
+        itr->series->reset(history_samples, edges);
+      else
+        itr->series->grow(edges);
+    }
+  }
 
-    metrics->setEdgeValue(edge, static_cast<double>(metric));
+  return true;
+}
 
-    return true;
+/**
+ * @brief apply rows appended to a CSV source in batches
+ *
+ * Rows arriving within one batch are applied under a single hold so
+ * observers only flush once per batch, and start one history snapshot.
+ * Columns are bound again whenever the fabric of the graph was
+ * replaced by a topology import since the last batch.
+ */
+class follow_t
+{
+public:
+  typedef std::chrono::steady_clock steady_t;
+
+  const std::string filename;
+  tlp::Graph * const graph;
+
+  ///rows read and rows not applied to any port
+  size_t rows;
+  size_t skipped;
+
+  follow_t(
+    const std::string &_filename,
+    tlp::Graph * const _graph,
+    const columns_t &_columns,
+    const bool _counter_deltas,
+    const int _history_samples,
+    const uint _guid_column,
+    const uint _portnum_column,
+    const uint _timestamp_column,
+    const uint _counter_width
+  ) :
+    filename(_filename),
+    graph(_graph),
+    rows(0),
+    skipped(0),
+    columns(_columns),
+    counter_deltas(_counter_deltas),
+    history_samples(_history_samples),
+    guid_column(_guid_column),
+    portnum_column(_portnum_column),
+    timestamp_column(_timestamp_column),
+    counter_width(_counter_width),
+    bound(NULL),
+    latest(0)
+  {
+    assert(graph);
   }
 
   /**
-   * Function called at the end of the parsing.
-   * @param rowNumber the number of row read in the file.
-   * @param columnNumber The column number for the line with the greatest column number.
+   * @brief open source, resuming after the rows already applied to fabric
    */
-  virtual bool end(unsigned int rowNumber, unsigned int columnNumber)
+  bool open(ib::tulip_fabric_t * const fabric)
   {
-    return true;
+    return tail.open(filename, fabric->csv_offsets[filename]);
   }
+
+  /**
+   * @brief read and apply one batch of rows
+   * @param fabric current fabric of graph
+   * @param interval milliseconds to wait for rows, 0 to only apply rows already available
+   * @return false if the source was closed or failed, or a field can not be written
+   */
+  bool batch(ib::tulip_fabric_t * const fabric, const int interval)
+  {
+    assert(fabric);
+
+    std::string conflict;
+    if(fabric != bound && !bind_columns(graph, fabric, counter_deltas, history_samples, columns, conflict))
+      return false;
+    bound = fabric;
+
+    handler_t handler(guid_column, portnum_column, timestamp_column, counter_width, columns, fabric);
+    handler.latest = latest;
+
+    const steady_t::time_point deadline = steady_t::now() + std::chrono::milliseconds(interval);
+    bool pushed = false;
+    bool open = true;
+
+    tlp::Observable::holdObservers();
+    do
+    {
+      const int wait = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - steady_t::now()).count());
+      if(!tail.poll(interval ? std::max(wait, 1) : 0))
+      {
+        open = false;
+        break;
+      }
+
+      while(tail.next(tokens))
+      {
+        if(!pushed)
+        {
+          push_history(columns);
+          pushed = true;
+        }
+
+        ++rows;
+        if(!handler.line(tokens))
+          ++skipped;
+      }
+    }
+    while(steady_t::now() < deadline);
+    tlp::Observable::unholdObservers();
+
+    latest = handler.latest;
+    if(pushed)
+      time_history(columns, latest);
+
+    fabric->csv_offsets[filename] = tail.offset();
+
+    return open;
+  }
+
+private:
+  columns_t columns;
+  const bool counter_deltas;
+  const int history_samples;
+  const uint guid_column;
+  const uint portnum_column;
+  const uint timestamp_column;
+  const uint counter_width;
+
+  ///fabric columns are bound to
+  const ib::tulip_fabric_t * bound;
+
+  ///newest timestamp seen
+  uint64_t latest;
+
+  ib::csv_tail_t tail;
+  std::vector<ib::token_t> tokens;
+};
+
+/**
+ * @brief follow a CSV source from the Qt event loop
+ *
+ * A timer applies whatever arrived every batch interval, so the import
+ * returns right away and views update after every batch. Batches wait
+ * while observers are held (another plugin is running), so rows are
+ * never applied under a hold that would not flush or into a fabric
+ * that is being replaced.
+ *
+ * Owned by the fabric of the graph, and stops once follow seconds
+ * passed, the source closed or the graph was deleted.
+ */
+class timed_follow_t : public QObject, public tlp::Observable, public ib::tulip_fabric_t::follower_t
+{
+public:
+  timed_follow_t(follow_t * const _follow, const int _batch_interval, const int _follow_seconds) :
+    follow(_follow),
+    batch_interval(_batch_interval),
+    follow_seconds(_follow_seconds),
+    timer(0)
+  {
+    assert(follow);
+  }
+
+  ~timed_follow_t()
+  {
+    stop();
+    delete follow;
+  }
+
+  /**
+   * @brief apply rows already available and start timer
+   * @return false if source could not be opened or read
+   */
+  bool start(ib::tulip_fabric_t * const fabric)
+  {
+    assert(!timer);
+
+    if(!follow->open(fabric) || !follow->batch(fabric, 0))
+      return false;
+
+    start_time = follow_t::steady_t::now();
+    timer = startTimer(batch_interval);
+    follow->graph->addListener(this);
+
+    return timer != 0;
+  }
+
+protected:
+  void timerEvent(QTimerEvent *)
+  {
+    if(tlp::Observable::observersHoldCounter())
+      return;
+
+    const long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(follow_t::steady_t::now() - start_time).count();
+    ib::tulip_fabric_t * const fabric = ib::tulip_fabric_t::find_fabric(follow->graph, false);
+
+    if(
+      !fabric ||
+      !follow->batch(fabric, 0) ||
+      (follow_seconds && elapsed >= follow_seconds * 1000LL)
+    )
+      stop();
+  }
+
+  void treatEvent(const tlp::Event &event)
+  {
+    if(event.type() == tlp::Event::TLP_DELETE && event.sender() == follow->graph)
+    {
+      ///graph is gone, never touch it again
+      killTimer(timer);
+      timer = 0;
+    }
+  }
+
+private:
+  void stop()
+  {
+    if(!timer)
+      return;
+
+    killTimer(timer);
+    timer = 0;
+    follow->graph->removeListener(this);
+
+#ifndef NDEBUG
+    std::cerr << "stopped following " << follow->filename << ": applied " <<
+      follow->rows - follow->skipped << " of " << follow->rows << " rows" << std::endl;
+#endif
+  }
+
+  follow_t * const follow;
+  const int batch_interval;
+  const int follow_seconds;
+
+  int timer;
+  follow_t::steady_t::time_point start_time;
 };
 
+/**
+ * @brief apply rows appended to source in batches until stopped, without an event loop
+ * @return false if source could not be opened or read
+ */
+static bool follow_blocking(
+  follow_t &follow,
+  const int batch_interval,
+  const int follow_seconds,
+  ib::tulip_fabric_t * const fabric,
+  tlp::PluginProgress * const pluginProgress
+)
+{
+  if(!follow.open(fabric))
+    return false;
+
+  const follow_t::steady_t::time_point start = follow_t::steady_t::now();
+
+  for(;;)
+  {
+    if(!follow.batch(fabric, batch_interval))
+      return follow.rows > 0;
+
+    const long long elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(follow_t::steady_t::now() - start).count();
+    if(follow_seconds && elapsed >= follow_seconds * 1000LL)
+      break;
+
+    if(pluginProgress)
+    {
+      std::stringstream comment;
+      comment << "Following CSV: applied " << follow.rows - follow.skipped << " of " << follow.rows << " rows";
+      pluginProgress->setComment(comment.str());
+
+      const tlp::ProgressState state = follow_seconds ?
+        pluginProgress->progress(static_cast<int>(elapsed), follow_seconds * 1000) :
+        pluginProgress->progress(1, 2);
+
+      if(state != tlp::TLP_CONTINUE)
+        break;
+    }
+  }
+
+  return true;
+}
 
 bool ImportInfinibandCSV::run()
 {
@@ -245,39 +815,232 @@ bool ImportInfinibandCSV::run()
   int portnum_column;
   int data_column;
   std::string data_name;
+  std::string data_columns;
+  int timestamp_column = 0;
+  bool counter_deltas = false;
+  int counter_width = 64;
+  int history_samples = 0;
+  bool follow_file = false;
+  int batch_interval = 250;
+  int follow_seconds = 0;
 
   dataSet->get("file::filename", filename);
   dataSet->get("GUID Column", guid_column);
   dataSet->get("Portnum Column", portnum_column);
   dataSet->get("Data Column", data_column);
   dataSet->get("Data Name", data_name);
+  dataSet->get("Data Columns", data_columns);
+  dataSet->get("Timestamp Column", timestamp_column);
+  dataSet->get("Counter Deltas", counter_deltas);
+  dataSet->get("Counter Width", counter_width);
+  dataSet->get("History Samples", history_samples);
+  dataSet->get("Follow", follow_file);
+  dataSet->get("Batch Interval", batch_interval);
+  dataSet->get("Follow Seconds", follow_seconds);
+
+  if(
+    timestamp_column < 0 || counter_width < 1 || counter_width > 64 ||
+    history_samples < 0 || batch_interval < 1 || follow_seconds < 0
+  )
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Invalid Timestamp Column, Counter Width, History Samples, Batch Interval or Follow Seconds.");
+
+    return false;
+  }
+
+  ///nothing could stop following without a progress object
+  if(follow_file && !follow_seconds && !pluginProgress)
+  {
+    std::cerr << "Follow Seconds must be set to follow " << filename << " without a progress object." << std::endl;
+    return false;
+  }
 
   /**
-   * use tulips simple CSV parser
+   * importing a followed file again stops following it
    */
-  tlp::CSVSimpleParser parser(filename, ",");
+  const std::map<std::string, ib::tulip_fabric_t::follower_t*>::iterator follower = fabric->followers.find(filename);
+  if(follower != fabric->followers.end())
+  {
+    delete follower->second;
+    fabric->followers.erase(follower);
+  }
 
-  if(pluginProgress)
+  /**
+   * every column is filled in the same pass over the file
+   */
+  columns_t columns;
+  if(data_columns.find_first_not_of(" \t") == std::string::npos)
+  {
+    const column_t column = { static_cast<uint>(data_column), data_name, NULL, NULL, NULL, NULL, NULL, NULL };
+    columns.push_back(column);
+  }
+  else if(!parse_columns(data_columns, columns))
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Invalid Data Columns. Expected column:field pairs separated by commas.");
+
+    return false;
+  }
+
+  std::string conflict;
+  if(!bind_columns(graph, fabric, counter_deltas, history_samples, columns, conflict))
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Field " + conflict + " (or its Raw, Delta or Rate field) already exists with another type.");
+
+    return false;
+  }
+
+  if(follow_file)
+  {
+    if(ib::detect_compression(filename) != ib::COMPRESSION_NONE)
+    {
+      if(pluginProgress)
+        pluginProgress->setError("Compressed files can not be followed.");
+
+      return false;
+    }
+
+    if(pluginProgress)
+    {
+      pluginProgress->setComment("Following CSV");
+      pluginProgress->progress(2, STEPS);
+    }
+
+    follow_t * const follow = new follow_t(
+      filename, graph, columns, counter_deltas, history_samples,
+      guid_column, portnum_column, timestamp_column, counter_width
+    );
+
+    /**
+     * with an event loop (the GUI) follow in the background so
+     * observers held by the caller flush and views update
+     */
+    if(QCoreApplication::instance())
+    {
+      timed_follow_t * const follower = new timed_follow_t(follow, batch_interval, follow_seconds);
+      if(!follower->start(fabric))
+      {
+        delete follower;
+
+        if(pluginProgress)
+          pluginProgress->setError("Unable open or read source.");
+
+        return false;
+      }
+
+      fabric->followers[filename] = follower;
+
+      if(pluginProgress)
+      {
+        pluginProgress->setComment("Following CSV in the background");
+        pluginProgress->progress(STEPS, STEPS);
+      }
+
+      return true;
+    }
+
+    const bool followed = follow_blocking(*follow, batch_interval, follow_seconds, fabric, pluginProgress);
+    delete follow;
+
+    if(!followed)
+    {
+      if(pluginProgress)
+        pluginProgress->setError("Unable open or read source.");
+
+      return false;
+    }
+
+    if(pluginProgress)
+    {
+      pluginProgress->setComment("Following CSV stopped");
+      pluginProgress->progress(STEPS, STEPS);
+    }
+
+    return true;
+  }
+
+  handler_t handler(guid_column, portnum_column, timestamp_column, counter_width, columns, fabric);
+
+  /**
+   * map the file and tokenize it in place
+   */
+  ib::csv_reader_t reader(',');
+  if(!reader.open(filename))
   {
-    pluginProgress->setComment("Parsing CSV");
-    pluginProgress->progress(2, STEPS);
+    if(pluginProgress)
+      pluginProgress->setError("Unable open source file.");
+
+    return false;
   }
 
-  MetricProperty * ibMetric = graph->getProperty<MetricProperty>(data_name);
-  assert(ibMetric);
+  ib::import_progress_t progress(pluginProgress);
+  progress.stage("Parsing CSV");
 
-  //std::cerr << "opening file " << filename << std::endl;
-  handler_t *handler = new handler_t(guid_column, portnum_column, data_column, ibMetric, fabric);
-  assert(handler);
-  parser.parse(handler, pluginProgress);
-  delete handler;
+  rollback_t rollback(columns);
+  push_history(columns);
+
+  size_t rows = 0, skipped = 0;
+  std::vector<ib::token_t> tokens;
+
+  /**
+   * progress is reported every PROGRESS_ROWS rows, by bytes of
+   * the file on disk, its Cancel/Stop state is refreshed every 100 ms
+   */
+  static const size_t PROGRESS_ROWS = 4096;
+
+  tlp::Observable::holdObservers();
+  while(reader.next(tokens))
+  {
+    ++rows;
+    if(!handler.line(tokens))
+      ++skipped;
+
+    if(!(rows % PROGRESS_ROWS) && !progress.bytes(reader.offset(), reader.size()))
+      break;
+  }
+  tlp::Observable::unholdObservers();
+
+  ///Cancel drops the import, Stop keeps rows applied so far
+  if(progress.get_state() == tlp::TLP_CANCEL)
+  {
+    rollback.restore();
+
+    if(pluginProgress)
+      pluginProgress->setError("Import cancelled.");
+
+    return false;
+  }
+
+  if(reader.failed())
+  {
+    rollback.restore();
+
+    if(pluginProgress)
+      pluginProgress->setError("Compressed source file is truncated or corrupt.");
+
+    return false;
+  }
+
+  time_history(columns, handler.latest);
+
+  ///a later follow resumes after this import
+  if(!progress.cancelled())
+    fabric->csv_offsets[filename] = reader.size();
+
+  const std::string timings = progress.finish();
+
+#ifndef NDEBUG
+  std::cerr << "imported " << rows - skipped << " of " << rows << " rows from " << filename <<
+    " (" << timings << ")" << std::endl;
+#endif
 
   if(pluginProgress)
   {
-    pluginProgress->setComment("Parsing CSV complete");
+    pluginProgress->setComment("Parsing CSV complete (" + timings + ")");
     pluginProgress->progress(STEPS, STEPS);
   }
 
   return true;
 }
-
@@ -0,0 +1,208 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "csv_reader.h"
+
+namespace ib = infiniband;
+
+ib::csv_reader_t::csv_reader_t(const char _separator)
+  : separator(_separator), opened(false), mapping(NULL), mapping_size(0), position(0), input_done(false)
+{
+}
+
+ib::csv_reader_t::~csv_reader_t()
+{
+  close();
+}
+
+bool ib::csv_reader_t::open(const std::string &filename)
+{
+  close();
+
+  if(detect_compression(filename) != COMPRESSION_NONE)
+  {
+    if(!input.open(filename))
+      return false;
+
+    opened = true;
+    return true;
+  }
+
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  ///mmap() refuses empty files
+  if(st.st_size > 0)
+  {
+    mapping_size = st.st_size;
+    mapping = mmap(NULL, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if(mapping == MAP_FAILED)
+    {
+      ::close(fd);
+      mapping = NULL;
+      mapping_size = 0;
+      return false;
+    }
+
+    madvise(mapping, mapping_size, MADV_SEQUENTIAL);
+  }
+
+  ::close(fd);
+  opened = true;
+  return true;
+}
+
+void ib::csv_reader_t::close()
+{
+  if(mapping)
+    munmap(mapping, mapping_size);
+
+  input.close();
+  buffer.clear();
+  input_done = false;
+
+  opened = false;
+  mapping = NULL;
+  mapping_size = 0;
+  position = 0;
+}
+
+/**
+ * @brief strip blanks and double quotes around field
+ */
+static inline ib::token_t make_token(const char *begin, const char *end)
+{
+  while(begin < end && (*begin == ' ' || *begin == '\t' || *begin == '"'))
+    ++begin;
+  while(end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '"' || end[-1] == '\r'))
+    --end;
+
+  const ib::token_t token = { begin, static_cast<size_t>(end - begin) };
+  return token;
+}
+
+bool ib::csv_reader_t::next(std::vector<ib::token_t> &tokens)
+{
+  if(input.is_open())
+    return next_streamed(tokens);
+
+  tokens.clear();
+
+  const char * const data = static_cast<const char *>(mapping);
+  while(position < mapping_size)
+  {
+    const char * const line = data + position;
+    const char *end = static_cast<const char *>(memchr(line, '\n', mapping_size - position));
+    if(!end)
+      end = data + mapping_size;
+
+    position = end - data + 1;
+    if(position > mapping_size)
+      position = mapping_size;
+
+    if(tokenize(line, end, separator, tokens))
+      return true;
+  }
+
+  return false;
+}
+
+bool ib::csv_reader_t::next_streamed(std::vector<ib::token_t> &tokens)
+{
+  tokens.clear();
+
+  for(;;)
+  {
+    if(position < buffer.size())
+    {
+      const char * const line = &buffer[position];
+      const char *end = static_cast<const char *>(memchr(line, '\n', buffer.size() - position));
+
+      ///last line may lack its newline
+      if(end || input_done)
+      {
+        if(!end)
+          end = &buffer[0] + buffer.size();
+
+        position = std::min<size_t>(end - &buffer[0] + 1, buffer.size());
+        if(tokenize(line, end, separator, tokens))
+          return true;
+
+        continue;
+      }
+    }
+
+    if(input_done)
+      return false;
+
+    ///keep partial line and append next block
+    buffer.erase(buffer.begin(), buffer.begin() + std::min(position, buffer.size()));
+    position = 0;
+
+    const char *data = NULL;
+    size_t size = 0;
+    if(input.next_block(data, size))
+      buffer.insert(buffer.end(), data, data + size);
+    else
+      input_done = true;
+  }
+}
+
+bool ib::csv_reader_t::tokenize(const char * const line, const char * const end, const char separator, std::vector<ib::token_t> &tokens)
+{
+  tokens.clear();
+
+  ///skip blank lines
+  const char *last = end;
+  while(last > line && (last[-1] == '\r' || last[-1] == ' ' || last[-1] == '\t'))
+    --last;
+  if(last == line)
+    return false;
+
+  const char *field = line;
+  for(;;)
+  {
+    const char *sep = static_cast<const char *>(memchr(field, separator, last - field));
+    if(!sep)
+    {
+      tokens.push_back(make_token(field, last));
+      break;
+    }
+
+    tokens.push_back(make_token(field, sep));
+    field = sep + 1;
+  }
+
+  return true;
+}
@@ -0,0 +1,149 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <cstddef>
+#include "numbers.h"
+#include "input_stream.h"
+
+#ifndef IB_TULIP_CSV_READER_H
+#define IB_TULIP_CSV_READER_H
+
+namespace infiniband
+{
+
+/**
+ * @brief field of a CSV line pointing into the mapped file
+ */
+struct token_t
+{
+  const char *data;
+  size_t size;
+
+  bool empty() const { return !size; }
+  std::string str() const { return std::string(data, size); }
+};
+
+/**
+ * @brief parse hex token
+ * @see infiniband::parse_hex()
+ */
+inline bool parse_hex(const token_t &token, uint64_t &value)
+{
+  return parse_hex(token.data, token.size, value);
+}
+
+/**
+ * @brief parse decimal token
+ * @see infiniband::parse_uint()
+ */
+inline bool parse_uint(const token_t &token, uint64_t &value)
+{
+  return parse_uint(token.data, token.size, value);
+}
+
+/**
+ * @brief Memory mapped CSV tokenizer
+ *
+ * Lines are split in place: tokens point into the mapping and are valid
+ * until close(). Surrounding blanks and double quotes are stripped from
+ * every field, quoted separators are not supported.
+ *
+ * Compressed files (gzip, zstd) are streamed through input_stream_t
+ * instead of mapped, their tokens are only valid until the next call
+ * of next().
+ */
+class csv_reader_t
+{
+public:
+  csv_reader_t(const char _separator = ',');
+  ~csv_reader_t();
+
+  /**
+   * @brief map file, or start decompressing it
+   * @return true if file is mapped (empty files have no lines)
+   */
+  bool open(const std::string &filename);
+
+  /**
+   * @brief unmap file
+   */
+  void close();
+
+  bool is_open() const { return opened; }
+
+  /**
+   * @brief size of file on disk in bytes
+   */
+  size_t size() const { return input.is_open() ? input.size() : mapping_size; }
+
+  /**
+   * @brief bytes of file on disk consumed so far
+   */
+  size_t offset() const { return input.is_open() ? input.offset() : position; }
+
+  /**
+   * @brief true if a compressed file was truncated or corrupt
+   */
+  bool failed() const { return input.failed(); }
+
+  /**
+   * @brief tokenize next non empty line
+   * @param tokens cleared then filled with every field of the line
+   * @return false at end of file
+   */
+  bool next(std::vector<token_t> &tokens);
+
+  /**
+   * @brief split one line (without newline) in place
+   * @param tokens cleared then filled with every field of the line
+   * @return false if line is blank
+   */
+  static bool tokenize(const char * const line, const char * const end, const char separator, std::vector<token_t> &tokens);
+
+private:
+  csv_reader_t(const csv_reader_t &);
+  csv_reader_t &operator=(const csv_reader_t &);
+
+  /**
+   * @brief next() of compressed files
+   */
+  bool next_streamed(std::vector<token_t> &tokens);
+
+  const char separator;
+  bool opened;
+  void *mapping;
+  size_t mapping_size;
+  size_t position;
+
+  /**
+   * @brief decompressed lines of compressed files
+   */
+  input_stream_t input;
+  std::vector<char> buffer;
+  bool input_done;
+};
+
+}
+
+#endif // IB_TULIP_CSV_READER_H
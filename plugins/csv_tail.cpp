@@ -0,0 +1,232 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "csv_tail.h"
+
+namespace ib = infiniband;
+
+/**
+ * @brief most bytes read per poll() so catching up on a large
+ * file does not hold all of it in memory
+ */
+static const size_t READ_LIMIT = 16 * 1024 * 1024;
+static const size_t READ_CHUNK = 64 * 1024;
+
+ib::csv_tail_t::csv_tail_t(const char _separator)
+  : separator(_separator), fd(-1), regular(false), socket(false), position(0), file_offset(0)
+{
+}
+
+ib::csv_tail_t::~csv_tail_t()
+{
+  close();
+}
+
+bool ib::csv_tail_t::open(const std::string &path, const off_t offset)
+{
+  close();
+
+  struct stat st;
+  if(stat(path.c_str(), &st) != 0)
+    return false;
+
+  if(S_ISSOCK(st.st_mode))
+  {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    if(path.size() >= sizeof(address.sun_path))
+      return false;
+
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0)
+      return false;
+
+    if(connect(fd, reinterpret_cast<const struct sockaddr *>(&address), sizeof(address)) != 0)
+    {
+      close();
+      return false;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    socket = true;
+    return true;
+  }
+
+  ///FIFOs must not block until a writer shows up
+  fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+  if(fd < 0)
+    return false;
+
+  regular = S_ISREG(st.st_mode);
+  if(regular && offset > 0 && offset <= st.st_size)
+  {
+    if(lseek(fd, offset, SEEK_SET) != offset)
+    {
+      close();
+      return false;
+    }
+
+    file_offset = offset;
+  }
+
+  return true;
+}
+
+void ib::csv_tail_t::close()
+{
+  if(fd >= 0)
+    ::close(fd);
+
+  fd = -1;
+  regular = false;
+  socket = false;
+  buffer.clear();
+  position = 0;
+  file_offset = 0;
+}
+
+ssize_t ib::csv_tail_t::fill(const size_t limit)
+{
+  ssize_t total = 0;
+  while(static_cast<size_t>(total) < limit)
+  {
+    const size_t used = buffer.size();
+    buffer.resize(used + READ_CHUNK);
+
+    const ssize_t count = read(fd, &buffer[used], READ_CHUNK);
+    buffer.resize(used + (count > 0 ? count : 0));
+
+    if(count > 0)
+    {
+      total += count;
+      continue;
+    }
+
+    if(count < 0 && errno == EINTR)
+      continue;
+
+    if(count < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+      return -1;
+
+    ///EOF or nothing more for now
+    if(!total && count == 0)
+      return 0;
+
+    break;
+  }
+
+  return total;
+}
+
+bool ib::csv_tail_t::poll(const int timeout)
+{
+  if(fd < 0)
+    return false;
+
+  ///drop lines already handed out
+  buffer.erase(buffer.begin(), buffer.begin() + position);
+  position = 0;
+
+  if(regular)
+  {
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+      return false;
+
+    if(st.st_size < file_offset)
+    {
+      ///truncated or rotated
+      if(lseek(fd, 0, SEEK_SET) != 0)
+        return false;
+
+      buffer.clear();
+      file_offset = 0;
+    }
+
+    if(st.st_size == file_offset)
+    {
+      ::poll(NULL, 0, timeout);
+      return true;
+    }
+
+    const ssize_t count = fill(READ_LIMIT);
+    if(count < 0)
+      return false;
+
+    file_offset += count;
+    return true;
+  }
+
+  struct pollfd pfd;
+  pfd.fd = fd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  if(::poll(&pfd, 1, timeout) < 0)
+    return errno == EINTR;
+
+  if(!pfd.revents)
+    return true;
+
+  const ssize_t count = fill(READ_LIMIT);
+  if(count < 0)
+    return false;
+
+  if(!count)
+  {
+    if(socket)
+      return false;
+
+    ///FIFO without writer polls as hung up until one opens it
+    ::poll(NULL, 0, timeout);
+  }
+
+  return true;
+}
+
+bool ib::csv_tail_t::next(std::vector<ib::token_t> &tokens)
+{
+  tokens.clear();
+
+  while(position < buffer.size())
+  {
+    const char * const line = &buffer[position];
+    const char * const end = static_cast<const char *>(memchr(line, '\n', buffer.size() - position));
+    if(!end)
+      return false; ///partial line
+
+    position = end - &buffer[0] + 1;
+
+    if(ib::csv_reader_t::tokenize(line, end, separator, tokens))
+      return true;
+  }
+
+  return false;
+}
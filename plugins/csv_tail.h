@@ -0,0 +1,112 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <string>
+#include <sys/types.h>
+#include "csv_reader.h"
+
+#ifndef IB_TULIP_CSV_TAIL_H
+#define IB_TULIP_CSV_TAIL_H
+
+namespace infiniband
+{
+
+/**
+ * @brief Follow a growing CSV file, FIFO or Unix socket
+ *
+ * Reads whatever has been appended since the last poll() and hands out
+ * complete lines only, a partial last line is kept until its newline
+ * arrives. Regular files that shrink (truncated or rotated) are read
+ * again from the start.
+ */
+class csv_tail_t
+{
+public:
+  csv_tail_t(const char _separator = ',');
+  ~csv_tail_t();
+
+  /**
+   * @brief open source
+   * @param path regular file, FIFO or Unix stream socket
+   * @param offset byte offset to resume regular files from
+   * @return true if source is open
+   */
+  bool open(const std::string &path, const off_t offset = 0);
+
+  void close();
+
+  bool is_open() const { return fd >= 0; }
+
+  /**
+   * @brief read everything available, waiting up to timeout if there is nothing new
+   * @param timeout milliseconds to wait
+   * @return false if a socket was closed by its peer or on read error
+   */
+  bool poll(const int timeout);
+
+  /**
+   * @brief tokenize next complete line
+   * @note tokens are valid until the next poll()
+   * @param tokens cleared then filled with every field of the line
+   * @return false if there is no complete line left
+   */
+  bool next(std::vector<token_t> &tokens);
+
+  /**
+   * @brief byte offset of regular file up to the last line handed out
+   */
+  off_t offset() const { return file_offset - static_cast<off_t>(buffer.size() - position); }
+
+private:
+  csv_tail_t(const csv_tail_t &);
+  csv_tail_t &operator=(const csv_tail_t &);
+
+  /**
+   * @brief read up to limit bytes
+   * @return bytes read, 0 at EOF or -1 on error
+   */
+  ssize_t fill(const size_t limit);
+
+  const char separator;
+  int fd;
+
+  /**
+   * @brief type of source
+   */
+  bool regular;
+  bool socket;
+
+  /**
+   * @brief bytes read and start of unconsumed bytes in buffer
+   */
+  std::vector<char> buffer;
+  size_t position;
+
+  /**
+   * @brief bytes read from regular file
+   */
+  off_t file_offset;
+};
+
+}
+
+#endif // IB_TULIP_CSV_TAIL_H
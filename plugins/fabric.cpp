@@ -17,8 +17,17 @@
  * See the GNU General Public License for more details.
  *
  */
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include <sys/stat.h>
 #include "fabric.h"
+#include "forwarding.h"
+#include "input_stream.h"
+#include "string_pool.h"
 #include "ibautils/ib_fabric.h"
+#include "ibautils/ib_parser.h"
 #include "ibautils/regex.h"
 
 namespace ib = infiniband;
@@ -33,7 +42,18 @@ ib::tulip_fabric_t * ib::tulip_fabric_t::find_fabric(tlp::Graph * const graph, b
   const map_t::iterator fabric_itr = map.find(graph);
 
   if(fabric_itr != map.end())
+  {
+    ///Parse fabric that was populated from cache on first use
+    if(fabric_itr->second->is_deferred() && !fabric_itr->second->load_deferred())
+    {
+      ///half built fabric can not be used or loaded again
+      delete fabric_itr->second;
+      map.erase(fabric_itr);
+      return NULL;
+    }
+
     return fabric_itr->second;
+  }
   else
   {
     if(!create)
@@ -51,68 +71,314 @@ ib::tulip_fabric_t * ib::tulip_fabric_t::find_fabric(tlp::Graph * const graph, b
   }
 }
 
-tlp::node& ib::tulip_fabric_t::get_entity_node(const ib::guid_t& guid)
+const tlp::node &ib::tulip_fabric_t::get_entity_node(const ib::guid_t& guid) const
 {
-  entities_t::iterator entityitr = find_entity(guid);
-  if(entityitr == entities.end()) abort();
-  
-  entity_nodes_t::iterator itr = entity_nodes.find(&entityitr->second);
-  if(itr != entity_nodes.end())
-    return itr->second;
-  
+  const entity_slot_t * const slot = find_entity_node(guid);
+  if(slot)
+    return slot->node;
+
   ///should not happen!
-  assert(itr != entity_nodes.end());
+  assert(slot);
   abort();
 }
 
+const ib::adjacency_t &ib::tulip_fabric_t::get_adjacency() const
+{
+  return ib::adjacency_t::find(graph);
+}
+
+void ib::tulip_fabric_t::insert_node(ib::entity_t * const entity, const tlp::node &node)
+{
+  std::pair<ib::tulip_fabric_t::entity_nodes_t::const_iterator, bool> result = entity_nodes.insert(std::make_pair(entity, node));
+  assert(result.second); ///should never fail!
+  assert(result.first->second == node);
+
+  if(node.id >= node_entities.size())
+    node_entities.resize(std::max<size_t>(node.id + 1, graph->numberOfNodes()), NULL);
+  node_entities[node.id] = entity;
+
+  const entity_slot_t slot = { entity, node };
+  entity_index.insert(entity->guid, slot);
+}
+
+void ib::tulip_fabric_t::insert_edge(ib::port_t * const port, const tlp::edge &edge)
+{
+  std::pair<ib::tulip_fabric_t::port_edges_t::iterator, bool> result = port_edges.insert(std::make_pair(port, edge));
+  assert(result.second); ///should never fail!
+  assert(result.first->second == edge);
+
+  if(edge.id >= edge_ports.size())
+    edge_ports.resize(std::max<size_t>(edge.id + 1, graph->numberOfEdges()), NULL);
+  edge_ports[edge.id] = port;
+
+  const port_slot_t slot = { port, edge };
+  port_index.insert(ib::guid_port_t(port->guid, port->port), slot);
+}
+
 ib::tulip_fabric_t::tulip_fabric_t(tlp::Graph * const _graph)
-  : graph(_graph)
+  : graph(_graph), routes_mtime(0), routes_size(0), forwarding(NULL), fields_populated(false)
 {
   assert(graph);
 }
 
-void ib::tulip_fabric_t::populate(const bool populateFields)
+ib::tulip_fabric_t::~tulip_fabric_t()
 {
-  tlp::StringProperty * viewLabel = 0;
-  ///Using string for GUID since integer is 32bits (on x86)
-  tlp::StringProperty * ibGuid = 0;
-  tlp::IntegerProperty * ibPortNum = 0;
-  tlp::IntegerProperty * ibLid = 0;
-  tlp::IntegerProperty * ibHca = 0;
-  tlp::StringProperty * ibWidth = 0;
-  tlp::StringProperty * ibSpeed = 0;
-  tlp::StringProperty * ibName = 0;
-  tlp::StringProperty * ibLeaf = 0;
-  tlp::StringProperty * ibSpine = 0;
+  for(std::map<std::string, follower_t*>::iterator itr = followers.begin(); itr != followers.end(); ++itr)
+    delete itr->second;
 
-  if(populateFields)
+  reset_forwarding();
+}
+
+void ib::tulip_fabric_t::reset_forwarding()
+{
+  delete forwarding;
+  forwarding = NULL;
+}
+
+bool ib::tulip_fabric_t::load_routes(const std::string &filename, const ib::progress_t &progress)
+{
+  struct stat st;
+  if(stat(filename.c_str(), &st) != 0)
+    return false;
+
+  ///Already loaded and unchanged
+  if(
+    filename == routes_source &&
+    st.st_mtime == routes_mtime &&
+    st.st_size == routes_size
+  )
+    return true;
+
+  ///plain, gzip or zstd
+  ib::input_stream_t input;
+  if(!input.open(filename))
+    return false;
+
+  input.set_progress(progress);
+
+  reset_forwarding();
+  routes_source.clear();
+
+  std::istream is(&input);
+  if(!lft.parse(is) || input.failed() || input.cancelled())
   {
-    viewLabel = graph->getProperty<tlp::StringProperty>("viewLabel");
-    ibGuid = graph->getProperty<tlp::StringProperty>("ibGuid");
-    ibWidth = graph->getProperty<tlp::StringProperty>("ibWidth");
-    ibSpeed = graph->getProperty<tlp::StringProperty>("ibSpeed");
-    ibName = graph->getProperty<tlp::StringProperty>("ibName");
-    ibLeaf = graph->getProperty<tlp::StringProperty>("ibLeaf");
-    ibSpine = graph->getProperty<tlp::StringProperty>("ibSpine");
-    ibPortNum = graph->getProperty<tlp::IntegerProperty >("ibPortNum");
-    ibLid = graph->getProperty<tlp::IntegerProperty >("ibLid");
-    ibHca = graph->getProperty<tlp::IntegerProperty >("ibHca");
+    lft.clear();
+    return false;
   }
-  
+
+  routes_source = filename;
+  routes_mtime = st.st_mtime;
+  routes_size = st.st_size;
+
+  return true;
+}
+
+const ib::forwarding_t &ib::tulip_fabric_t::get_forwarding()
+{
+  if(!forwarding)
+    forwarding = new ib::forwarding_t(*this);
+
+  assert(forwarding);
+  return *forwarding;
+}
+
+namespace
+{
+
+/**
+ * @brief field values of a new node
+ */
+struct node_fields_t
+{
+  ///repetitive labels are interned in a string_pool_t that lives for one populate()
+  const std::string *label;
+  const std::string *name;
+  const std::string *leaf;
+  const std::string *spine;
+  std::string guid;
+  int port_count;
+  int lid;
+  int hca;
+};
+
+/**
+ * @brief field values of a new edge
+ */
+struct edge_fields_t
+{
+  std::string name;
+  std::string label;
+  ///repetitive values are interned in a string_pool_t that lives for one populate()
+  const std::string *guid;
+  const std::string *width;
+  const std::string *speed;
+  const std::string *leaf;
+  const std::string *spine;
+  int port;
+  int lid;
+  int hca;
+};
+
+/**
+ * @brief write fields of new nodes and edges one property at a time
+ * @param skip fields not to write (still deferred)
+ * @note caller is expected to hold observers
+ */
+void write_fields(
+  tlp::Graph * const graph,
+  const std::vector<tlp::node> &nodes,
+  const std::vector<node_fields_t> &node_fields,
+  const std::vector<tlp::edge> &edges,
+  const std::vector<edge_fields_t> &edge_fields,
+  const std::set<std::string> &skip = std::set<std::string>()
+)
+{
+  assert(nodes.size() == node_fields.size());
+  assert(edges.size() == edge_fields.size());
+
+  ///properties of skipped fields are not even created
+  tlp::StringProperty * viewLabel = skip.count("viewLabel") ? NULL : graph->getProperty<tlp::StringProperty>("viewLabel");
+  ///Using string for GUID since integer is 32bits (on x86), it survives TLP files unlike a custom type
+  tlp::StringProperty * ibGuid = skip.count("ibGuid") ? NULL : graph->getProperty<tlp::StringProperty>("ibGuid");
+  tlp::StringProperty * ibWidth = skip.count("ibWidth") ? NULL : graph->getProperty<tlp::StringProperty>("ibWidth");
+  tlp::StringProperty * ibSpeed = skip.count("ibSpeed") ? NULL : graph->getProperty<tlp::StringProperty>("ibSpeed");
+  tlp::StringProperty * ibName = skip.count("ibName") ? NULL : graph->getProperty<tlp::StringProperty>("ibName");
+  tlp::StringProperty * ibLeaf = skip.count("ibLeaf") ? NULL : graph->getProperty<tlp::StringProperty>("ibLeaf");
+  tlp::StringProperty * ibSpine = skip.count("ibSpine") ? NULL : graph->getProperty<tlp::StringProperty>("ibSpine");
+  tlp::IntegerProperty * ibPortNum = skip.count("ibPortNum") ? NULL : graph->getProperty<tlp::IntegerProperty >("ibPortNum");
+  tlp::IntegerProperty * ibLid = skip.count("ibLid") ? NULL : graph->getProperty<tlp::IntegerProperty >("ibLid");
+  tlp::IntegerProperty * ibHca = skip.count("ibHca") ? NULL : graph->getProperty<tlp::IntegerProperty >("ibHca");
+
+  for(size_t i = 0; viewLabel && i < nodes.size(); ++i)
+    viewLabel->setNodeValue(nodes[i], *node_fields[i].label);
+  for(size_t i = 0; ibName && i < nodes.size(); ++i)
+    ibName->setNodeValue(nodes[i], *node_fields[i].name);
+  for(size_t i = 0; ibLeaf && i < nodes.size(); ++i)
+    ibLeaf->setNodeValue(nodes[i], *node_fields[i].leaf);
+  for(size_t i = 0; ibSpine && i < nodes.size(); ++i)
+    ibSpine->setNodeValue(nodes[i], *node_fields[i].spine);
+  for(size_t i = 0; ibPortNum && i < nodes.size(); ++i)
+    ibPortNum->setNodeValue(nodes[i], node_fields[i].port_count); ///define list of known port count on this entity
+  for(size_t i = 0; ibGuid && i < nodes.size(); ++i)
+    ibGuid->setNodeValue(nodes[i], node_fields[i].guid);
+  for(size_t i = 0; ibLid && i < nodes.size(); ++i)
+    ibLid->setNodeValue(nodes[i], node_fields[i].lid);
+  for(size_t i = 0; ibHca && i < nodes.size(); ++i)
+    ibHca->setNodeValue(nodes[i], node_fields[i].hca);
+
+  for(size_t i = 0; ibName && i < edges.size(); ++i)
+    ibName->setEdgeValue(edges[i], edge_fields[i].name);
+  for(size_t i = 0; viewLabel && i < edges.size(); ++i)
+    viewLabel->setEdgeValue(edges[i], edge_fields[i].label);
+  for(size_t i = 0; ibGuid && i < edges.size(); ++i)
+    ibGuid->setEdgeValue(edges[i], *edge_fields[i].guid);
+  for(size_t i = 0; ibWidth && i < edges.size(); ++i)
+    ibWidth->setEdgeValue(edges[i], *edge_fields[i].width);
+  for(size_t i = 0; ibSpeed && i < edges.size(); ++i)
+    ibSpeed->setEdgeValue(edges[i], *edge_fields[i].speed);
+  for(size_t i = 0; ibLeaf && i < edges.size(); ++i)
+    ibLeaf->setEdgeValue(edges[i], *edge_fields[i].leaf);
+  for(size_t i = 0; ibSpine && i < edges.size(); ++i)
+    ibSpine->setEdgeValue(edges[i], *edge_fields[i].spine);
+  for(size_t i = 0; ibPortNum && i < edges.size(); ++i)
+    ibPortNum->setEdgeValue(edges[i], edge_fields[i].port);
+  for(size_t i = 0; ibLid && i < edges.size(); ++i)
+    ibLid->setEdgeValue(edges[i], edge_fields[i].lid);
+  for(size_t i = 0; ibHca && i < edges.size(); ++i)
+    ibHca->setEdgeValue(edges[i], edge_fields[i].hca);
+}
+
+/**
+ * @brief field values of entities
+ * @param labels pool interning repetitive labels
+ */
+void make_node_fields(
+  ib::string_pool_t &labels,
+  const std::vector<ib::entity_t*> &entities,
+  std::vector<node_fields_t> &node_fields
+)
+{
+  node_fields.resize(entities.size());
+  for(size_t i = 0; i < entities.size(); ++i)
+  {
+    typedef ib::entity_t l;
+    const ib::entity_t &entity = *entities[i];
+    node_fields_t &fields = node_fields[i];
+
+    fields.label = &labels.intern(entity.label(l::LABEL_ENTITY_ONLY));
+    fields.name = &labels.intern(entity.label(l::LABEL_NAME_ONLY));
+    fields.leaf = &labels.intern(entity.label(l::LABEL_LEAF_ONLY));
+    fields.spine = &labels.intern(entity.label(l::LABEL_SPINE_ONLY));
+    fields.port_count = entity.ports.size();
+    fields.guid = regex::string_cast_uint(entity.guid);
+    fields.lid = entity.lid();
+    fields.hca = entity.hca();
+  }
+}
+
+/**
+ * @brief field values of connected ports
+ * @param labels pool interning repetitive labels
+ */
+void make_edge_fields(
+  ib::string_pool_t &labels,
+  const std::vector<ib::port_t*> &ports,
+  std::vector<edge_fields_t> &edge_fields
+)
+{
+  /**
+   * every port label is used by both edges of its cable
+   */
+  std::unordered_map<const ib::port_t*, std::string> port_labels;
+  const auto port_label = [&port_labels](const ib::port_t * const port) -> const std::string &
+  {
+    std::unordered_map<const ib::port_t*, std::string>::iterator itr = port_labels.find(port);
+    if(itr == port_labels.end())
+      itr = port_labels.insert(std::make_pair(port, port->label())).first;
+
+    return itr->second;
+  };
+
+  edge_fields.resize(ports.size());
+  for(size_t i = 0; i < ports.size(); ++i)
+  {
+    typedef ib::port_t l;
+    const ib::port_t * const port = ports[i];
+    edge_fields_t &fields = edge_fields[i];
+
+    fields.name = port->label(l::LABEL_FULL);
+    ///Dump full label for edges with both ports
+    fields.label = port_label(port) + " <--> " + port_label(port->connection);
+    fields.guid = &labels.intern(regex::string_cast_uint(port->guid));
+    fields.width = &labels.intern(port->width);
+    fields.speed = &labels.intern(port->speed);
+    fields.leaf = &labels.intern(regex::string_cast_uint(port->leaf));
+    fields.spine = &labels.intern(regex::string_cast_uint(port->spine));
+    fields.port = port->port;
+    fields.lid = port->lid;
+    fields.hca = port->hca;
+  }
+}
+
+
+}
+
+void ib::tulip_fabric_t::populate(const bool populateFields)
+{
   /**
    * Create the tulip graph by having the following
    * 1 node = 1 entity
    * 2 edges = 1 cable (1 edge in each direction)
+   *
+   * Observers are held for the whole import and nodes, edges and
+   * fields are created in bulk to avoid per element notifications.
    */
+  tlp::Observable::holdObservers();
 
   /**
-   * reserve 2 edges per cable
-   */
-  graph->reserveEdges(get_portmap().size() * 2);
-  
-  /**
-   * Walk every entity and create every node
+   * Walk every entity and collect every missing node
    */
+  std::vector<ib::entity_t*> new_entities;
   for(
     ib::fabric_t::entities_t::const_iterator 
       itr = get_entities().begin(),
@@ -121,39 +387,45 @@ void ib::tulip_fabric_t::populate(const bool populateFields)
     ++itr
   )
   {
-    const ib::entity_t &entity = itr->second;
+    ib::entity_t * const entity = const_cast<ib::entity_t*>(&itr->second);
     
-    if(entity_nodes.find(const_cast<ib::entity_t*>(&entity)) == entity_nodes.end())
+    if(!find_entity_node(entity->guid))
     {
       /**
-       * Create node and insert it into map
+       * Attach to node created from cache
        */
-      tlp::node node = graph->addNode();
-      assert(node.isValid());
-      assert(graph->getRoot()->isElement(node));
-      
-      std::pair<ib::tulip_fabric_t::entity_nodes_t::const_iterator, bool> result = entity_nodes.insert(std::make_pair(const_cast<ib::entity_t*>(&entity), node));
-      assert(result.second); ///should never fail!
-      assert(result.first->second == node);
-      
-      if(populateFields)
+      const std::map<ib::guid_t, tlp::node>::iterator cached = cached_nodes.find(entity->guid);
+      if(cached != cached_nodes.end())
       {
-        typedef ib::entity_t l;
-        viewLabel->setNodeValue(node, entity.label(l::LABEL_ENTITY_ONLY));
-        ibName->setNodeValue(node, entity.label(l::LABEL_NAME_ONLY));
-        ibLeaf->setNodeValue(node, entity.label(l::LABEL_LEAF_ONLY));
-        ibSpine->setNodeValue(node, entity.label(l::LABEL_SPINE_ONLY));
-        ibPortNum->setNodeValue(node, entity.ports.size()); ///define list of known port count on this entity
-        ibGuid->setNodeValue(node, regex::string_cast_uint(entity.guid));
-        ibLid->setNodeValue(node, entity.lid());
-        ibHca->setNodeValue(node, entity.hca());
+        insert_node(entity, cached->second);
+        cached_nodes.erase(cached);
+        continue;
       }
+
+      new_entities.push_back(entity);
     }
   }
+
+  /**
+   * Create nodes in bulk and insert them into map
+   */
+  std::vector<tlp::node> nodes;
+  if(!new_entities.empty())
+    graph->addNodes(new_entities.size(), nodes);
+  assert(nodes.size() == new_entities.size());
+
+  for(size_t i = 0; i < new_entities.size(); ++i)
+  {
+    assert(nodes[i].isValid());
+    assert(graph->getRoot()->isElement(nodes[i]));
+    insert_node(new_entities[i], nodes[i]);
+  }
     
   /**
-    * Walk every port and create every edge
+    * Walk every port and collect every missing edge
     */
+  std::vector<ib::port_t*> new_ports;
+  std::vector<std::pair<tlp::node, tlp::node> > ends;
   for(
     ib::fabric_t::portmap_guidport_t::const_iterator
       itr = get_portmap().begin(),
@@ -162,44 +434,634 @@ void ib::tulip_fabric_t::populate(const bool populateFields)
     ++itr
   )
   {
-    ib::port_t const * const port = itr->second;
+    ib::port_t * const port = itr->second;
     assert(port);
     
-    if(port->connection)
+    if(port->connection && !find_port_edge(port->guid, port->port))
     {
+      /**
+       * Attach to edge created from cache
+       */
+      const std::map<ib::port_t::key_guid_port_t, tlp::edge>::iterator cached = cached_edges.find(ib::port_t::key_guid_port_t(port->guid, port->port));
+      if(cached != cached_edges.end())
+      {
+        insert_edge(port, cached->second);
+        cached_edges.erase(cached);
+        continue;
+      }
+
       tlp::node n1 = get_entity_node(port->guid);
       tlp::node n2 = get_entity_node(port->connection->guid);
       assert(n1.isValid()); assert(n2.isValid());
       
-      tlp::edge edge = graph->addEdge(n1, n2);
-      assert(edge.isValid());
-      
-      std::pair<ib::tulip_fabric_t::port_edges_t::iterator, bool> result = port_edges.insert(std::make_pair(const_cast<ib::port_t*>(port), edge));
-      assert(result.second); ///should never fail!
-      assert(result.first->second == edge);
-     
-      if(populateFields)
+      new_ports.push_back(port);
+      ends.push_back(std::make_pair(n1, n2));
+    }
+  }
+
+  /**
+   * Create edges in bulk and insert them into map
+   */
+  std::vector<tlp::edge> edges;
+  if(!ends.empty())
+    graph->addEdges(ends, edges);
+  assert(edges.size() == new_ports.size());
+
+  for(size_t i = 0; i < new_ports.size(); ++i)
+  {
+    assert(edges[i].isValid());
+    insert_edge(new_ports[i], edges[i]);
+  }
+
+  /**
+   * without populateFields, fields already written on every
+   * node and edge (such as required lazy fields) are still
+   * written for the new ones
+   */
+  std::set<std::string> skip;
+  if(!populateFields)
+    unwritten_fields(skip);
+
+  if(skip.size() < field_names().size())
+  {
+    ///Tulip keeps its own copy: labels are only pooled while fields are written
+    ib::string_pool_t labels;
+    std::vector<node_fields_t> node_fields;
+    make_node_fields(labels, new_entities, node_fields);
+    std::vector<edge_fields_t> edge_fields;
+    make_edge_fields(labels, new_ports, edge_fields);
+
+    write_fields(graph, nodes, node_fields, edges, edge_fields, skip);
+  }
+
+  if(populateFields)
+  {
+    fields_populated = true;
+    deferred_fields.clear();
+  }
+
+  tlp::Observable::unholdObservers();
+
+  /**
+   * nodes and edges changed: drop any stale snapshot
+   */
+  if(!nodes.empty() || !edges.empty())
+    ib::adjacency_t::invalidate(graph);
+  reset_forwarding();
+}
+
+void ib::tulip_fabric_t::populate(ib::tulip_fabric_t &previous, const bool populateFields, ib::tulip_fabric_t::diff_t &diff)
+{
+  assert(graph == previous.graph);
+  assert(entity_nodes.empty() && port_edges.empty());
+  assert(!previous.is_deferred());
+
+  const diff_t none = { 0, 0, 0, 0, 0, 0 };
+  diff = none;
+
+  /**
+   * Adopt node of every entity that is still on the fabric
+   */
+  std::vector<bool> kept_nodes(previous.node_entities.size(), false);
+  std::vector<ib::entity_t*> kept_entities, old_entities;
+  for(
+    ib::fabric_t::entities_t::const_iterator
+      itr = get_entities().begin(),
+      eitr = get_entities().end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    const entity_slot_t * const slot = previous.find_entity_node(itr->second.guid);
+    if(!slot)
+      continue;
+
+    cached_nodes.insert(std::make_pair(slot->entity->guid, slot->node));
+    kept_nodes[slot->node.id] = true;
+    kept_entities.push_back(const_cast<ib::entity_t*>(&itr->second));
+    old_entities.push_back(slot->entity);
+  }
+
+  /**
+   * Adopt edge of every port still cabled to the same remote port
+   */
+  std::vector<bool> kept_edges(previous.edge_ports.size(), false);
+  std::vector<ib::port_t*> kept_ports, old_ports;
+  for(
+    ib::fabric_t::portmap_guidport_t::const_iterator
+      itr = get_portmap().begin(),
+      eitr = get_portmap().end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    ib::port_t * const port = itr->second;
+    assert(port);
+    if(!port->connection)
+      continue;
+
+    const port_slot_t * const slot = previous.find_port_edge(port->guid, port->port);
+    if(
+      !slot ||
+      !slot->port->connection ||
+      slot->port->connection->guid != port->connection->guid ||
+      slot->port->connection->port != port->connection->port
+    )
+      continue;
+
+    cached_edges.insert(std::make_pair(ib::port_t::key_guid_port_t(port->guid, port->port), slot->edge));
+    kept_edges[slot->edge.id] = true;
+    kept_ports.push_back(port);
+    old_ports.push_back(slot->port);
+  }
+
+  tlp::Observable::holdObservers();
+
+  /**
+   * Delete edges of unplugged or moved cables and nodes of
+   * missing entities before populate() reuses their ids
+   */
+  for(
+    ib::tulip_fabric_t::port_edges_t::const_iterator
+      itr = previous.port_edges.begin(),
+      eitr = previous.port_edges.end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    if(kept_edges[itr->second.id])
+      continue;
+
+    for(std::map<std::string, ib::counter_history_t>::iterator citr = previous.counters.begin(); citr != previous.counters.end(); ++citr)
+      citr->second.forget(itr->second);
+    for(std::map<std::string, ib::metric_series_t>::iterator sitr = previous.series.begin(); sitr != previous.series.end(); ++sitr)
+      sitr->second.forget(itr->second);
+
+    if(graph->isElement(itr->second))
+      graph->delEdge(itr->second, true);
+    ++diff.edges_removed;
+  }
+
+  for(
+    ib::tulip_fabric_t::entity_nodes_t::const_iterator
+      itr = previous.entity_nodes.begin(),
+      eitr = previous.entity_nodes.end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    if(kept_nodes[itr->second.id])
+      continue;
+
+    if(graph->isElement(itr->second))
+      graph->delNode(itr->second, true);
+    ++diff.nodes_removed;
+  }
+
+  /**
+   * creates (and fills in) only the missing nodes and edges,
+   * with the fields written by the previous import
+   */
+  fields_populated = previous.fields_populated;
+  deferred_fields = previous.deferred_fields;
+  populate(populateFields);
+  assert(cached_nodes.empty() && cached_edges.empty());
+
+  diff.nodes_added = entity_nodes.size() - kept_entities.size();
+  diff.edges_added = port_edges.size() - kept_ports.size();
+
+  /**
+   * Rewrite fields of kept nodes and edges whose data changed,
+   * such as a cable that came back at another width or speed.
+   * Fields the previous import never wrote (Populate Fields off,
+   * or lazy fields) are written for every kept node and edge.
+   * Without populateFields only the fields previously written
+   * are rewritten, the others stay deferred.
+   */
+  std::set<std::string> skip;
+  if(!populateFields)
+    unwritten_fields(skip);
+
+  if(skip.size() < field_names().size())
+  {
+    const bool write_all = populateFields && (!previous.fields_populated || !previous.deferred_fields.empty());
+
+    ///interned fields of both fabrics are comparable by address
+    ib::string_pool_t labels;
+    std::vector<node_fields_t> new_node_fields, old_node_fields;
+    make_node_fields(labels, kept_entities, new_node_fields);
+    make_node_fields(labels, old_entities, old_node_fields);
+
+    std::vector<tlp::node> nodes;
+    std::vector<node_fields_t> node_fields;
+    for(size_t i = 0; i < kept_entities.size(); ++i)
+    {
+      const node_fields_t &a = new_node_fields[i];
+      const node_fields_t &b = old_node_fields[i];
+
+      const bool changed =
+        a.label != b.label || a.name != b.name ||
+        a.leaf != b.leaf || a.spine != b.spine ||
+        a.port_count != b.port_count || a.lid != b.lid || a.hca != b.hca;
+
+      if(changed)
+        ++diff.nodes_changed;
+
+      if(changed || write_all)
+      {
+        nodes.push_back(get_entity_node(kept_entities[i]->guid));
+        node_fields.push_back(a);
+      }
+    }
+
+    std::vector<edge_fields_t> new_edge_fields, old_edge_fields;
+    make_edge_fields(labels, kept_ports, new_edge_fields);
+    make_edge_fields(labels, old_ports, old_edge_fields);
+
+    std::vector<tlp::edge> edges;
+    std::vector<edge_fields_t> edge_fields;
+    for(size_t i = 0; i < kept_ports.size(); ++i)
+    {
+      const edge_fields_t &a = new_edge_fields[i];
+      const edge_fields_t &b = old_edge_fields[i];
+
+      const bool changed =
+        a.name != b.name || a.label != b.label ||
+        a.width != b.width || a.speed != b.speed ||
+        a.leaf != b.leaf || a.spine != b.spine ||
+        a.port != b.port || a.lid != b.lid || a.hca != b.hca;
+
+      if(changed)
+        ++diff.edges_changed;
+
+      if(changed || write_all)
       {
-        typedef ib::port_t l;
-        ibName->setEdgeValue(edge, port->label(l::LABEL_FULL));
-        ///Dump full label for edges with both ports
-        const std::string label = port->label() + " <--> " + port->connection->label();
-        viewLabel->setEdgeValue(edge, label);
-        
-        ibGuid->setEdgeValue(edge, regex::string_cast_uint(port->guid));
-        ibWidth->setEdgeValue(edge, port->width);
-        ibSpeed->setEdgeValue(edge, port->speed);
-        ibLeaf->setEdgeValue(edge, regex::string_cast_uint(port->leaf));
-        ibSpine->setEdgeValue(edge, regex::string_cast_uint(port->spine));
-        ibPortNum->setEdgeValue(edge, port->port);
-        ibLid->setEdgeValue(edge, port->lid);
-        ibHca->setEdgeValue(edge, port->hca);
+        edges.push_back(find_port_edge(kept_ports[i]->guid, kept_ports[i]->port)->edge);
+        edge_fields.push_back(a);
       }
     }
+
+    write_fields(graph, nodes, node_fields, edges, edge_fields, skip);
+  }
+
+  tlp::Observable::unholdObservers();
+
+  /**
+   * Take over everything imported on top of the previous topology
+   */
+  std::swap(lft, previous.lft);
+  routes_source = previous.routes_source;
+  routes_mtime = previous.routes_mtime;
+  routes_size = previous.routes_size;
+  counters.swap(previous.counters);
+  series.swap(previous.series);
+  csv_offsets.swap(previous.csv_offsets);
+  followers.swap(previous.followers);
+}
+
+void ib::tulip_fabric_t::replace_fabric(ib::tulip_fabric_t * const fabric)
+{
+  assert(fabric);
+
+  ib::tulip_fabric_t *&slot = map[fabric->graph];
+  if(slot != fabric)
+  {
+    delete slot;
+    slot = fabric;
+  }
+}
+
+void ib::tulip_fabric_t::populate(ib::fabric_cache_t &cache, const std::string &source, const bool populateFields)
+{
+  assert(cache.is_open());
+
+  tlp::Observable::holdObservers();
+
+  /**
+   * Create every node and edge in bulk
+   */
+  std::vector<tlp::node> nodes;
+  graph->addNodes(cache.entity_count(), nodes);
+  assert(nodes.size() == cache.entity_count());
+
+  std::vector<std::pair<tlp::node, tlp::node> > ends;
+  ends.reserve(cache.cable_count());
+  for(uint32_t i = 0; i < cache.cable_count(); ++i)
+  {
+    const ib::fabric_cache_t::cable_record_t &cable = cache.cable(i);
+    ends.push_back(std::make_pair(nodes[cable.entity], nodes[cable.peer_entity]));
+  }
+
+  std::vector<tlp::edge> edges;
+  graph->addEdges(ends, edges);
+  assert(edges.size() == cache.cable_count());
+
+  for(uint32_t i = 0; i < cache.entity_count(); ++i)
+    cached_nodes.insert(std::make_pair(cache.entity(i).guid, nodes[i]));
+
+  for(uint32_t i = 0; i < cache.cable_count(); ++i)
+  {
+    const ib::fabric_cache_t::cable_record_t &cable = cache.cable(i);
+    cached_edges.insert(std::make_pair(ib::port_t::key_guid_port_t(cable.guid, cable.port), edges[i]));
+  }
+
+  if(populateFields)
+  {
+    ib::string_pool_t labels;
+    std::vector<node_fields_t> node_fields(cache.entity_count());
+    for(uint32_t i = 0; i < cache.entity_count(); ++i)
+    {
+      const ib::fabric_cache_t::entity_record_t &entity = cache.entity(i);
+      node_fields_t &fields = node_fields[i];
+
+      fields.label = &labels.intern(cache.string(entity.label_entity));
+      fields.name = &labels.intern(cache.string(entity.label_name));
+      fields.leaf = &labels.intern(cache.string(entity.label_leaf));
+      fields.spine = &labels.intern(cache.string(entity.label_spine));
+      fields.port_count = entity.port_count;
+      fields.guid = regex::string_cast_uint(entity.guid);
+      fields.lid = entity.lid;
+      fields.hca = entity.hca;
+    }
+
+    std::vector<edge_fields_t> edge_fields(cache.cable_count());
+    for(uint32_t i = 0; i < cache.cable_count(); ++i)
+    {
+      const ib::fabric_cache_t::cable_record_t &cable = cache.cable(i);
+      edge_fields_t &fields = edge_fields[i];
+
+      fields.name = cache.string(cable.label_full);
+      fields.label = cache.string(cable.label_cable);
+      fields.guid = &labels.intern(regex::string_cast_uint(cable.guid));
+      fields.width = &labels.intern(cache.string(cable.width));
+      fields.speed = &labels.intern(cache.string(cable.speed));
+      fields.leaf = &labels.intern(regex::string_cast_uint(cable.leaf));
+      fields.spine = &labels.intern(regex::string_cast_uint(cable.spine));
+      fields.port = cable.port;
+      fields.lid = cable.lid;
+      fields.hca = cable.hca;
+    }
+
+    write_fields(graph, nodes, node_fields, edges, edge_fields);
+    fields_populated = true;
+  }
+
+  tlp::Observable::unholdObservers();
+
+  deferred_source = source;
+  deferred_cache.swap(cache);
+  if(!nodes.empty() || !edges.empty())
+    ib::adjacency_t::invalidate(graph);
+  reset_forwarding();
+}
+
+const std::vector<std::string> &ib::tulip_fabric_t::field_names()
+{
+  static const char * const names[] = {
+    "viewLabel", "ibGuid", "ibWidth", "ibSpeed", "ibName",
+    "ibLeaf", "ibSpine", "ibPortNum", "ibLid", "ibHca"
+  };
+  static const std::vector<std::string> fields(names, names + sizeof(names) / sizeof(names[0]));
+
+  return fields;
+}
+
+bool ib::tulip_fabric_t::find_field_conflict(tlp::Graph * const graph, std::string &conflict)
+{
+  for(
+    std::vector<std::string>::const_iterator
+      itr = field_names().begin(),
+      eitr = field_names().end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    if(!graph->existProperty(*itr))
+      continue;
+
+    ///port number, LID and HCA are integers, every other field is a string
+    const bool integer = *itr == "ibPortNum" || *itr == "ibLid" || *itr == "ibHca";
+    const std::string &type = integer ? tlp::IntegerProperty::propertyTypename : tlp::StringProperty::propertyTypename;
+
+    if(graph->getProperty(*itr)->getTypename() != type)
+    {
+      conflict = *itr;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ib::tulip_fabric_t::defer_fields()
+{
+  ///fields written on every node and edge are never deferred again
+  if(fields_populated || !deferred_fields.empty())
+    return;
+
+  deferred_fields.insert(field_names().begin(), field_names().end());
+}
+
+void ib::tulip_fabric_t::unwritten_fields(std::set<std::string> &fields) const
+{
+  fields.clear();
+  if(fields_populated)
+    return;
+
+  ///no field was deferred: none was written
+  if(deferred_fields.empty())
+    fields.insert(field_names().begin(), field_names().end());
+  else
+    fields = deferred_fields;
+}
+
+bool ib::tulip_fabric_t::require_field(const std::string &name)
+{
+  const std::set<std::string>::iterator itr = deferred_fields.find(name);
+  if(itr == deferred_fields.end())
+    return graph->existProperty(name);
+
+  if(is_deferred() && !load_deferred())
+    return false;
+
+  if(!populate_field(name))
+    return false;
+
+  deferred_fields.erase(name);
+  if(deferred_fields.empty())
+    fields_populated = true;
+
+  return true;
+}
+
+bool ib::tulip_fabric_t::populate_field(const std::string &name)
+{
+  typedef ib::entity_t el;
+  typedef ib::port_t pl;
+
+  ///same order as field_names()
+  enum field_t {
+    VIEW_LABEL = 0, GUID, WIDTH, SPEED, NAME,
+    LEAF, SPINE, PORT_NUM, LID, HCA
+  };
+
+  const std::vector<std::string>::const_iterator name_itr = std::find(field_names().begin(), field_names().end(), name);
+  if(name_itr == field_names().end())
+    return false;
+
+  const field_t field = static_cast<field_t>(name_itr - field_names().begin());
+
+  tlp::StringProperty * strings = NULL;
+  tlp::IntegerProperty * integers = NULL;
+
+  ///never cast a field of another type
+  if(field == PORT_NUM || field == LID || field == HCA)
+    integers = ib::get_typed_property<tlp::IntegerProperty>(graph, name);
+  else
+    strings = ib::get_typed_property<tlp::StringProperty>(graph, name);
+
+  if(!strings && !integers)
+    return false;
+
+  tlp::Observable::holdObservers();
+
+  for(
+    entity_nodes_t::const_iterator
+      itr = entity_nodes.begin(),
+      eitr = entity_nodes.end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    const ib::entity_t &entity = *itr->first;
+    const tlp::node &node = itr->second;
+
+    switch(field)
+    {
+      case VIEW_LABEL:
+        strings->setNodeValue(node, entity.label(el::LABEL_ENTITY_ONLY));
+        break;
+      case NAME:
+        strings->setNodeValue(node, entity.label(el::LABEL_NAME_ONLY));
+        break;
+      case LEAF:
+        strings->setNodeValue(node, entity.label(el::LABEL_LEAF_ONLY));
+        break;
+      case SPINE:
+        strings->setNodeValue(node, entity.label(el::LABEL_SPINE_ONLY));
+        break;
+      case GUID:
+        strings->setNodeValue(node, regex::string_cast_uint(entity.guid));
+        break;
+      case PORT_NUM:
+        integers->setNodeValue(node, entity.ports.size());
+        break;
+      case LID:
+        integers->setNodeValue(node, entity.lid());
+        break;
+      case HCA:
+        integers->setNodeValue(node, entity.hca());
+        break;
+      default:
+        break;
+    }
+  }
+
+  for(
+    port_edges_t::const_iterator
+      itr = port_edges.begin(),
+      eitr = port_edges.end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    const ib::port_t &port = *itr->first;
+    const tlp::edge &edge = itr->second;
+
+    switch(field)
+    {
+      case NAME:
+        strings->setEdgeValue(edge, port.label(pl::LABEL_FULL));
+        break;
+      case VIEW_LABEL:
+        strings->setEdgeValue(edge, port.label() + " <--> " + port.connection->label());
+        break;
+      case GUID:
+        strings->setEdgeValue(edge, regex::string_cast_uint(port.guid));
+        break;
+      case WIDTH:
+        strings->setEdgeValue(edge, port.width);
+        break;
+      case SPEED:
+        strings->setEdgeValue(edge, port.speed);
+        break;
+      case LEAF:
+        strings->setEdgeValue(edge, regex::string_cast_uint(port.leaf));
+        break;
+      case SPINE:
+        strings->setEdgeValue(edge, regex::string_cast_uint(port.spine));
+        break;
+      case PORT_NUM:
+        integers->setEdgeValue(edge, port.port);
+        break;
+      case LID:
+        integers->setEdgeValue(edge, port.lid);
+        break;
+      case HCA:
+        integers->setEdgeValue(edge, port.hca);
+        break;
+      default:
+        break;
+    }
   }
 
+  tlp::Observable::unholdObservers();
+
+  return true;
 }
 
+bool ib::tulip_fabric_t::load_deferred()
+{
+  assert(is_deferred());
+  assert(deferred_cache.is_open());
+
+  /**
+   * the graph was built from this cache: rebuild the
+   * fabric from its port records instead of the source
+   */
+  ib::parser::ibnetdiscover_p_t::portmap_t portmap;
+  if(!deferred_cache.load_ports(portmap) || !add_cables(portmap) || !build_lid_map(true))
+  {
+    ///never add the cables again
+    deferred_source.clear();
+    deferred_cache.close();
+    cached_nodes.clear();
+    cached_edges.clear();
+
+    return false;
+  }
 
+#ifndef NDEBUG
+  if(!deferred_cache.matches(deferred_source))
+    std::cerr << "warning: " << deferred_source << " changed since import, fabric restored from " <<
+      ib::fabric_cache_t::path(deferred_source) << " as imported" << std::endl;
+#endif
 
+  /**
+   * only attaches fabric to the cached nodes and edges
+   */
+  deferred_source.clear();
+  deferred_cache.close();
+  populate(false);
+
+#ifndef NDEBUG
+  if(!cached_nodes.empty() || !cached_edges.empty())
+    std::cerr << "warning: fabric cache has " << cached_nodes.size() << " nodes and " <<
+      cached_edges.size() << " edges not in its port records" << std::endl;
+#endif
 
+  cached_nodes.clear();
+  cached_edges.clear();
+
+  return true;
+}
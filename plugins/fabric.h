@@ -20,8 +20,20 @@
 #pragma once
 
 #include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <sys/types.h>
 #include <tulip/TulipPluginHeaders.h>
 #include "ibautils/ib_fabric.h"
+#include "adjacency.h"
+#include "fabric_cache.h"
+#include "lft.h"
+#include "typed_property.h"
+#include "flat_map.h"
+#include "counters.h"
+#include "series.h"
+#include "input_stream.h"
 
 #ifndef IB_TULIP_FABRIC_H
 #define IB_TULIP_FABRIC_H
@@ -41,12 +53,17 @@ namespace infiniband
  * drawback that any changes made by the user to the graph will have 
  * undefined results if any futher imports are made.
  *
+ * A topology imported again into the same graph is applied as a diff
+ * against the preserved fabric, see populate(tulip_fabric_t&, ...).
+ *
  */
 class tulip_fabric_t;
+class forwarding_t;
 class tulip_fabric_t : public infiniband::fabric_t
 {
 public:
   tulip_fabric_t(tlp::Graph * const _graph);
+  ~tulip_fabric_t();
 
   typedef std::map<entity_t*, tlp::node> entity_nodes_t;
   typedef std::map<port_t*, tlp::edge> port_edges_t;
@@ -62,20 +79,131 @@ public:
    * @brief map of port -> edge
    */
   port_edges_t port_edges;
+
+  /**
+   * @brief linear forwarding tables of the last imported routes
+   * @see load_routes()
+   */
+  lft_t lft;
+
+  /**
+   * @brief previous snapshot of imported counters per field name
+   */
+  std::map<std::string, counter_history_t> counters;
+
+  /**
+   * @brief retained snapshots of imported metrics per field name
+   */
+  std::map<std::string, metric_series_t> series;
+
+  /**
+   * @brief bytes of CSV files already applied, to resume following
+   */
+  std::map<std::string, off_t> csv_offsets;
+
+  /**
+   * @brief CSV source followed in the background
+   * @see ImportInfinibandCSV
+   */
+  class follower_t
+  {
+  public:
+    virtual ~follower_t() {}
+  };
+
+  /**
+   * @brief followers per CSV file, stopped and deleted with the fabric
+   */
+  std::map<std::string, follower_t*> followers;
+
+  /**
+   * @brief load routes (ibdiagnet2.fdbs) into lft
+   *
+   * Routes are only parsed again if filename, its size or its
+   * modification time changed since the last successful load.
+   *
+   * @param filename path of routes file
+   * @param progress called with bytes parsed, returning false cancels loading
+   * @return true if routes are loaded
+   */
+  bool load_routes(const std::string &filename, const progress_t &progress = progress_t());
+
+  /**
+   * @brief get forwarding engine over the loaded routes
+   * @note built on first use and kept until routes or graph change
+   */
+  const forwarding_t &get_forwarding();
   
+  /**
+   * @brief get entity of node
+   * @param node tulip node
+   * @return entity or NULL if node is not an entity of this fabric
+   */
+  entity_t *get_node_entity(const tlp::node &node) const
+  {
+    return node.id < node_entities.size() ? node_entities[node.id] : NULL;
+  }
+
+  /**
+   * @brief get port of edge
+   * @param edge tulip edge
+   * @return port or NULL if edge is not a port of this fabric
+   */
+  port_t *get_edge_port(const tlp::edge &edge) const
+  {
+    return edge.id < edge_ports.size() ? edge_ports[edge.id] : NULL;
+  }
+
+  /**
+   * @brief entity and node of a GUID
+   */
+  struct entity_slot_t
+  {
+    entity_t *entity;
+    tlp::node node;
+  };
+
+  /**
+   * @brief port and edge of a (GUID, port)
+   */
+  struct port_slot_t
+  {
+    port_t *port;
+    tlp::edge edge;
+  };
+
+  /**
+   * @brief find entity and node by GUID (single hash probe)
+   * @return slot or NULL if guid has no node
+   */
+  const entity_slot_t *find_entity_node(const guid_t &guid) const
+  {
+    return entity_index.find(guid);
+  }
+
+  /**
+   * @brief find port and edge by GUID and port number (single hash probe)
+   * @return slot or NULL if port has no edge
+   */
+  const port_slot_t *find_port_edge(const guid_t &guid, const port_num_t &port) const
+  {
+    return port_index.find(guid_port_t(guid, port));
+  }
+
   /**
   * @brief get entity node 
   * @warning node must always exist before calling this
   * @param guid entity guid
   * @return entity node
   */
-  tlp::node &get_entity_node(const guid_t &guid);
+  const tlp::node &get_entity_node(const guid_t &guid) const;
 
   /**
    * @brief get fabric for given graph
    * @param graph ptr to tulip graph
    * @param create create the tulip fabric if one is not found
    * @return pointer to tulip_fabric instance for requested graph or NULL if create=false
+   * @note NULL if the fabric of a graph populated from cache can not be loaded, the fabric is dropped
    */
   static tulip_fabric_t * find_fabric(tlp::Graph * const graph, bool create);
 
@@ -83,7 +211,170 @@ public:
    * @brief Populate Tulip based on IB fabric
    */
   void populate(const bool populateFields);
+
+  /**
+   * @brief Populate Tulip from a mapped fabric cache
+   *
+   * Creates the same nodes, edges and fields as populate() without
+   * the IB fabric. The fabric is rebuilt later on demand by
+   * load_deferred() from the port records of the same cache and
+   * attached to the nodes and edges made here.
+   *
+   * @param cache mapped sidecar of source, kept mapped until load_deferred()
+   * @param source path of topology file the cache was made from
+   */
+  void populate(fabric_cache_t &cache, const std::string &source, const bool populateFields);
+
+  /**
+   * @brief nodes and edges touched by an incremental populate
+   */
+  struct diff_t
+  {
+    size_t nodes_added;
+    size_t nodes_removed;
+    size_t nodes_changed;
+    size_t edges_added;
+    size_t edges_removed;
+    size_t edges_changed;
+  };
+
+  /**
+   * @brief Populate Tulip by diffing against the previous fabric of the graph
+   *
+   * Nodes of entities and edges of ports cabled to the same remote port
+   * in both fabrics are kept with every property; only their fields are
+   * rewritten, and only if their data changed or the previous import did
+   * not write fields. Missing nodes and edges are created and stale ones
+   * deleted from the graph. Routes, counter history, metric series,
+   * CSV offsets and followers are taken over from previous.
+   *
+   * @param previous preserved fabric of the same graph, released by replace_fabric()
+   * @param diff counts of touched nodes and edges
+   */
+  void populate(tulip_fabric_t &previous, const bool populateFields, diff_t &diff);
+
+  /**
+   * @brief preserve fabric for its graph, deleting the one it replaces
+   */
+  static void replace_fabric(tulip_fabric_t * const fabric);
+
+  /**
+   * @brief names of every field populate() can create
+   */
+  static const std::vector<std::string> &field_names();
+
+  /**
+   * @brief find a field that exists in graph with another type than populate() writes
+   * @param conflict set to the name of the field
+   * @return true if a field has another type
+   */
+  static bool find_field_conflict(tlp::Graph * const graph, std::string &conflict);
+
+  /**
+   * @brief populate fields lazily
+   *
+   * Fields are not created during populate() but only when
+   * requested via require_field(), from the entity and port data.
+   * Only call after populate(false). Fields already written on
+   * every node and edge are not deferred again; populate(false)
+   * keeps writing them for new nodes and edges.
+   */
+  void defer_fields();
+
+  /**
+   * @brief create field from fabric data if it has been deferred
+   * @param name field name, as in field_names()
+   * @return true if field exists after call
+   */
+  bool require_field(const std::string &name);
+
+  /**
+   * @brief check if IB fabric still needs to be parsed
+   */
+  bool is_deferred() const { return !deferred_source.empty(); }
+
+  /**
+   * @brief rebuild fabric from the deferred cache and attach it to the existing graph
+   * @return true if fabric is loaded, else the fabric is no longer deferred but incomplete
+   */
+  bool load_deferred();
+
+  /**
+   * @brief get adjacency snapshot of the fabric graph
+   * @see adjacency_t::find()
+   */
+  const adjacency_t &get_adjacency() const;
 private:
+  /**
+   * @brief add node and edge to maps and reverse indexes
+   */
+  void insert_node(entity_t * const entity, const tlp::node &node);
+  void insert_edge(port_t * const port, const tlp::edge &edge);
+
+  /**
+   * @brief write field of every node and edge of the fabric
+   */
+  bool populate_field(const std::string &name);
+
+  /**
+   * @brief fields not written on every node and edge
+   * @param fields set to still deferred fields, or every field if none was written
+   */
+  void unwritten_fields(std::set<std::string> &fields) const;
+
+  /**
+   * @brief drop forwarding engine after routes or graph change
+   */
+  void reset_forwarding();
+
+  /**
+   * @brief hash indexes of guid -> node and (guid, port) -> edge
+   */
+  flat_map_t<guid_t, entity_slot_t, guid_hash_t> entity_index;
+  flat_map_t<guid_port_t, port_slot_t, guid_port_hash_t> port_index;
+
+  /**
+   * @brief reverse index of node.id -> entity
+   */
+  std::vector<entity_t*> node_entities;
+
+  /**
+   * @brief reverse index of edge.id -> port
+   */
+  std::vector<port_t*> edge_ports;
+
+  /**
+   * @brief topology file and its cache to load on first use (populated from cache)
+   */
+  std::string deferred_source;
+  fabric_cache_t deferred_cache;
+
+  /**
+   * @brief nodes and edges created from cache waiting for the fabric
+   */
+  std::map<guid_t, tlp::node> cached_nodes;
+  std::map<port_t::key_guid_port_t, tlp::edge> cached_edges;
+
+  /**
+   * @brief routes file loaded into lft
+   */
+  std::string routes_source;
+  time_t routes_mtime;
+  off_t routes_size;
+
+  forwarding_t *forwarding;
+
+  /**
+   * @brief fields that have not been created yet
+   */
+  std::set<std::string> deferred_fields;
+
+  /**
+   * @brief every field was written for every node and edge, by
+   * populate() or by require_field() of every deferred field
+   */
+  bool fields_populated;
+
   /**
    * @brief type for static fabric map
    */
@@ -0,0 +1,498 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "fabric_cache.h"
+#include "fabric.h"
+
+namespace ib = infiniband;
+
+const uint32_t ib::fabric_cache_t::VERSION;
+const uint32_t ib::fabric_cache_t::NO_PEER;
+
+static const char MAGIC[8] = { 'I', 'B', 'F', 'A', 'B', 'R', 'I', 'C' };
+
+ib::fabric_cache_t::fabric_cache_t()
+  : mapping(NULL), mapping_size(0), header(NULL), entities(NULL), cables(NULL), ports(NULL), strings(NULL)
+{
+}
+
+ib::fabric_cache_t::~fabric_cache_t()
+{
+  close();
+}
+
+std::string ib::fabric_cache_t::path(const std::string &source)
+{
+  return source + ".ibcache";
+}
+
+bool ib::fabric_cache_t::fingerprint(const std::string &source, uint64_t &hash, uint64_t &size, int64_t &mtime)
+{
+  const int fd = ::open(source.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  size = st.st_size;
+  mtime = st.st_mtime;
+
+  /**
+   * FNV-1a over SAMPLES blocks spread from the first to the last
+   * block of the file (or over every byte of small files)
+   */
+  static const size_t BLOCK = 4096;
+  static const size_t SAMPLES = 64;
+
+  hash = 14695981039346656037ULL;
+  std::vector<unsigned char> block(BLOCK);
+
+  const size_t samples = size > SAMPLES * BLOCK ? SAMPLES : (size + BLOCK - 1) / BLOCK;
+  for(size_t i = 0; i < samples; ++i)
+  {
+    const off_t offset = samples == SAMPLES ?
+      static_cast<off_t>((size - BLOCK) / (SAMPLES - 1) * i) :
+      static_cast<off_t>(i * BLOCK);
+
+    const ssize_t count = pread(fd, &block[0], BLOCK, offset);
+    if(count < 0)
+    {
+      ::close(fd);
+      return false;
+    }
+
+    for(ssize_t j = 0; j < count; ++j)
+      hash = (hash ^ block[j]) * 1099511628211ULL;
+  }
+
+  ::close(fd);
+  return true;
+}
+
+namespace
+{
+  /**
+   * @brief string table builder (each distinct string stored once)
+   */
+  class string_table_t
+  {
+  public:
+    uint32_t add(const std::string &value)
+    {
+      const std::map<std::string, uint32_t>::const_iterator itr = offsets.find(value);
+      if(itr != offsets.end())
+        return itr->second;
+
+      const uint32_t offset = static_cast<uint32_t>(data.size());
+      data.insert(data.end(), value.begin(), value.end());
+      data.push_back('\0');
+      offsets.insert(std::make_pair(value, offset));
+      return offset;
+    }
+
+    std::vector<char> data;
+  private:
+    std::map<std::string, uint32_t> offsets;
+  };
+}
+
+bool ib::fabric_cache_t::write(const std::string &source, const ib::tulip_fabric_t &fabric)
+{
+  header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.header_size = sizeof(header_t);
+
+  if(!fingerprint(source, header.source_hash, header.source_size, header.source_mtime))
+    return false;
+
+  string_table_t strings;
+  std::vector<entity_record_t> entities;
+  std::vector<cable_record_t> cables;
+  std::vector<port_record_t> ports;
+  std::map<ib::guid_t, uint32_t> entity_index;
+
+  entities.reserve(fabric.get_entities().size());
+  for(
+    ib::fabric_t::entities_t::const_iterator
+      itr = fabric.get_entities().begin(),
+      eitr = fabric.get_entities().end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    typedef ib::entity_t l;
+    const ib::entity_t &entity = itr->second;
+
+    entity_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.guid = entity.guid;
+    record.label_entity = strings.add(entity.label(l::LABEL_ENTITY_ONLY));
+    record.label_name = strings.add(entity.label(l::LABEL_NAME_ONLY));
+    record.label_leaf = strings.add(entity.label(l::LABEL_LEAF_ONLY));
+    record.label_spine = strings.add(entity.label(l::LABEL_SPINE_ONLY));
+    record.port_count = entity.ports.size();
+    record.lid = entity.lid();
+    record.hca = entity.hca();
+
+    entity_index.insert(std::make_pair(entity.guid, static_cast<uint32_t>(entities.size())));
+    entities.push_back(record);
+  }
+
+  for(
+    ib::fabric_t::portmap_guidport_t::const_iterator
+      itr = fabric.get_portmap().begin(),
+      eitr = fabric.get_portmap().end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    typedef ib::port_t l;
+    ib::port_t const * const port = itr->second;
+    assert(port);
+
+    if(!port->connection)
+      continue;
+
+    const std::map<ib::guid_t, uint32_t>::const_iterator entity_itr = entity_index.find(port->guid);
+    const std::map<ib::guid_t, uint32_t>::const_iterator peer_itr = entity_index.find(port->connection->guid);
+    if(entity_itr == entity_index.end() || peer_itr == entity_index.end())
+      return false;
+
+    cable_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.guid = port->guid;
+    record.leaf = port->leaf;
+    record.spine = port->spine;
+    record.entity = entity_itr->second;
+    record.peer_entity = peer_itr->second;
+    record.label_full = strings.add(port->label(l::LABEL_FULL));
+    record.label_cable = strings.add(port->label() + " <--> " + port->connection->label());
+    record.width = strings.add(port->width);
+    record.speed = strings.add(port->speed);
+    record.lid = port->lid;
+    record.port = port->port;
+    record.hca = port->hca;
+
+    cables.push_back(record);
+  }
+
+  /**
+   * every port, connections as record indexes
+   */
+  std::unordered_map<const ib::port_t *, uint32_t> port_index;
+  port_index.reserve(fabric.get_portmap().size());
+  for(
+    ib::fabric_t::portmap_guidport_t::const_iterator
+      itr = fabric.get_portmap().begin(),
+      eitr = fabric.get_portmap().end();
+    itr != eitr;
+    ++itr
+  )
+    port_index.insert(std::make_pair(itr->second, static_cast<uint32_t>(port_index.size())));
+
+  ports.reserve(port_index.size());
+  for(
+    ib::fabric_t::portmap_guidport_t::const_iterator
+      itr = fabric.get_portmap().begin(),
+      eitr = fabric.get_portmap().end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    ib::port_t const * const port = itr->second;
+
+    port_record_t record;
+    memset(&record, 0, sizeof(record));
+    record.guid = port->guid;
+    record.leaf = port->leaf;
+    record.spine = port->spine;
+    record.name = strings.add(port->name);
+    record.width = strings.add(port->width);
+    record.speed = strings.add(port->speed);
+    record.peer = NO_PEER;
+    record.lid = port->lid;
+    record.port = port->port;
+    record.hca = port->hca;
+
+    if(port->connection)
+    {
+      const std::unordered_map<const ib::port_t *, uint32_t>::const_iterator peer = port_index.find(port->connection);
+      if(peer == port_index.end())
+        return false;
+
+      record.peer = peer->second;
+    }
+
+    ports.push_back(record);
+  }
+
+  header.entity_count = entities.size();
+  header.cable_count = cables.size();
+  header.port_count = ports.size();
+  header.strings_size = strings.data.size();
+
+  /**
+   * write to temporary file then rename to never leave a partial sidecar
+   */
+  const std::string target = path(source);
+  const std::string temporary = target + ".tmp";
+  {
+    std::ofstream ofs(temporary.c_str(), std::ios::binary | std::ios::trunc);
+    if(!ofs)
+      return false;
+
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    if(!entities.empty())
+      ofs.write(reinterpret_cast<const char *>(&entities[0]), entities.size() * sizeof(entity_record_t));
+    if(!cables.empty())
+      ofs.write(reinterpret_cast<const char *>(&cables[0]), cables.size() * sizeof(cable_record_t));
+    if(!ports.empty())
+      ofs.write(reinterpret_cast<const char *>(&ports[0]), ports.size() * sizeof(port_record_t));
+    if(!strings.data.empty())
+      ofs.write(&strings.data[0], strings.data.size());
+
+    if(!ofs)
+    {
+      ofs.close();
+      unlink(temporary.c_str());
+      return false;
+    }
+  }
+
+  return rename(temporary.c_str(), target.c_str()) == 0;
+}
+
+bool ib::fabric_cache_t::open(const std::string &source)
+{
+  close();
+
+  const std::string sidecar = path(source);
+  const int fd = ::open(sidecar.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(header_t))
+  {
+    ::close(fd);
+    return false;
+  }
+
+  mapping_size = st.st_size;
+  mapping = mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+
+  if(mapping == MAP_FAILED)
+  {
+    mapping = NULL;
+    return false;
+  }
+
+  const header_t * const candidate = static_cast<const header_t *>(mapping);
+  if(
+    memcmp(candidate->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+    candidate->version != VERSION ||
+    candidate->header_size != sizeof(header_t) ||
+    candidate->strings_size > mapping_size
+  )
+  {
+    close();
+    return false;
+  }
+
+  const uint64_t expected =
+    sizeof(header_t) +
+    static_cast<uint64_t>(candidate->entity_count) * sizeof(entity_record_t) +
+    static_cast<uint64_t>(candidate->cable_count) * sizeof(cable_record_t) +
+    static_cast<uint64_t>(candidate->port_count) * sizeof(port_record_t) +
+    candidate->strings_size;
+
+  if(expected != mapping_size)
+  {
+    close();
+    return false;
+  }
+
+  header = candidate;
+  entities = reinterpret_cast<const entity_record_t *>(header + 1);
+  cables = reinterpret_cast<const cable_record_t *>(entities + header->entity_count);
+  ports = reinterpret_cast<const port_record_t *>(cables + header->cable_count);
+  strings = reinterpret_cast<const char *>(ports + header->port_count);
+
+  if(!matches(source) || !validate())
+  {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+bool ib::fabric_cache_t::matches(const std::string &source) const
+{
+  assert(is_open());
+
+  uint64_t hash = 0, size = 0;
+  int64_t mtime = 0;
+  return
+    fingerprint(source, hash, size, mtime) &&
+    hash == header->source_hash &&
+    size == header->source_size &&
+    mtime == header->source_mtime;
+}
+
+bool ib::fabric_cache_t::validate() const
+{
+  const uint64_t strings_size = header->strings_size;
+
+  ///every string must end inside the table
+  if(strings_size && strings[strings_size - 1] != '\0')
+    return false;
+
+  for(uint32_t i = 0; i < header->entity_count; ++i)
+  {
+    const entity_record_t &record = entities[i];
+    if(
+      record.label_entity >= strings_size ||
+      record.label_name >= strings_size ||
+      record.label_leaf >= strings_size ||
+      record.label_spine >= strings_size
+    )
+      return false;
+  }
+
+  for(uint32_t i = 0; i < header->cable_count; ++i)
+  {
+    const cable_record_t &record = cables[i];
+    if(
+      record.entity >= header->entity_count ||
+      record.peer_entity >= header->entity_count ||
+      record.label_full >= strings_size ||
+      record.label_cable >= strings_size ||
+      record.width >= strings_size ||
+      record.speed >= strings_size
+    )
+      return false;
+  }
+
+  for(uint32_t i = 0; i < header->port_count; ++i)
+  {
+    const port_record_t &record = ports[i];
+    if(
+      (record.peer != NO_PEER && record.peer >= header->port_count) ||
+      record.name >= strings_size ||
+      record.width >= strings_size ||
+      record.speed >= strings_size
+    )
+      return false;
+  }
+
+  return true;
+}
+
+bool ib::fabric_cache_t::load_ports(ib::parser::ibnetdiscover_p_t::portmap_t &portmap) const
+{
+  assert(is_open());
+
+  std::vector<ib::port_t *> created(header->port_count, NULL);
+  for(uint32_t i = 0; i < header->port_count; ++i)
+  {
+    const port_record_t &record = ports[i];
+
+    ib::port_t * const port = new ib::port_t();
+    port->guid = record.guid;
+    port->port = record.port;
+    port->lid = record.lid;
+    port->hca = record.hca;
+    port->leaf = record.leaf;
+    port->spine = record.spine;
+    port->name = string(record.name);
+    port->width = string(record.width);
+    port->speed = string(record.speed);
+    port->connection = NULL;
+
+    if(!portmap.insert(std::make_pair(ib::port_t::key_guid_port_t(port->guid, port->port), port)).second)
+    {
+      ///duplicate port: records are inconsistent
+      delete port;
+      break;
+    }
+
+    created[i] = port;
+  }
+
+  for(uint32_t i = 0; i < header->port_count; ++i)
+  {
+    if(!created[i])
+    {
+      for(uint32_t j = 0; j < header->port_count; ++j)
+        delete created[j];
+      portmap.clear();
+
+      return false;
+    }
+
+    if(ports[i].peer != NO_PEER)
+      created[i]->connection = created[ports[i].peer];
+  }
+
+  return true;
+}
+
+void ib::fabric_cache_t::swap(ib::fabric_cache_t &other)
+{
+  std::swap(mapping, other.mapping);
+  std::swap(mapping_size, other.mapping_size);
+  std::swap(header, other.header);
+  std::swap(entities, other.entities);
+  std::swap(cables, other.cables);
+  std::swap(ports, other.ports);
+  std::swap(strings, other.strings);
+}
+
+void ib::fabric_cache_t::close()
+{
+  if(mapping)
+    munmap(mapping, mapping_size);
+
+  mapping = NULL;
+  mapping_size = 0;
+  header = NULL;
+  entities = NULL;
+  cables = NULL;
+  ports = NULL;
+  strings = NULL;
+}
@@ -0,0 +1,231 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <stdint.h>
+#include "ibautils/ib_fabric.h"
+#include "ibautils/ib_parser.h"
+
+#ifndef IB_TULIP_FABRIC_CACHE_H
+#define IB_TULIP_FABRIC_CACHE_H
+
+namespace infiniband
+{
+
+class tulip_fabric_t;
+
+/**
+ * @brief Binary sidecar cache of an imported fabric
+ *
+ * After a topology import the entities, cables and ports of the fabric
+ * are written next to the source file (<source>.ibcache) as fixed size
+ * records plus a string table. The cache is keyed by the size and
+ * modification time of the source file plus a hash of samples of its
+ * contents, and carries a format version. A later import of the same
+ * file maps the sidecar and builds the tulip graph straight from the
+ * records; the fabric itself is rebuilt from the port records on first
+ * use (see load_ports()) without parsing any text.
+ *
+ * The sidecar is read in place (mmap) so a warm start only costs the
+ * page faults of the records it touches. Every offset and index of the
+ * records is checked by open(), so a corrupt sidecar is rejected.
+ *
+ * Routes are not part of the cache: they come from their own file
+ * (ibdiagnet2.fdbs) and are parsed by their own import, which already
+ * skips a file that did not change (see tulip_fabric_t::load_routes()).
+ */
+class fabric_cache_t
+{
+public:
+  /**
+   * @brief increment on any change to the records below
+   */
+  static const uint32_t VERSION = 2;
+
+  /**
+   * @brief peer of a port record without connection
+   */
+  static const uint32_t NO_PEER = ~static_cast<uint32_t>(0);
+
+  struct header_t
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t source_hash;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint32_t entity_count;
+    uint32_t cable_count;
+    uint32_t port_count;
+    uint32_t padding;
+    uint64_t strings_size;
+  };
+
+  /**
+   * @brief one record per entity (node)
+   * @note strings are offsets into the string table
+   */
+  struct entity_record_t
+  {
+    uint64_t guid;
+    uint32_t label_entity;
+    uint32_t label_name;
+    uint32_t label_leaf;
+    uint32_t label_spine;
+    uint32_t port_count;
+    uint16_t lid;
+    uint8_t hca;
+    uint8_t padding;
+  };
+
+  /**
+   * @brief one record per connected port (directional edge)
+   */
+  struct cable_record_t
+  {
+    uint64_t guid;
+    uint64_t leaf;
+    uint64_t spine;
+    uint32_t entity;
+    uint32_t peer_entity;
+    uint32_t label_full;
+    uint32_t label_cable;
+    uint32_t width;
+    uint32_t speed;
+    uint16_t lid;
+    uint8_t port;
+    uint8_t hca;
+    uint32_t padding;
+  };
+
+  /**
+   * @brief one record per port of the fabric (connected or not)
+   * @note enough to rebuild the parsed port map of the source
+   */
+  struct port_record_t
+  {
+    uint64_t guid;
+    uint64_t leaf;
+    uint64_t spine;
+    uint32_t name;
+    uint32_t width;
+    uint32_t speed;
+    uint32_t peer; ///index of connected port record or NO_PEER
+    uint16_t lid;
+    uint8_t port;
+    uint8_t hca;
+    uint32_t padding;
+  };
+
+  fabric_cache_t();
+  ~fabric_cache_t();
+
+  /**
+   * @brief get sidecar path for source file
+   */
+  static std::string path(const std::string &source);
+
+  /**
+   * @brief cheap fingerprint of source file
+   *
+   * Hashes evenly spaced samples of the contents instead of every byte,
+   * size and modification time catch the changes samples miss.
+   *
+   * @param source path to source file
+   * @param hash set to hash of sampled contents
+   * @param size set to size of contents
+   * @param mtime set to modification time
+   * @return false if file can not be read
+   */
+  static bool fingerprint(const std::string &source, uint64_t &hash, uint64_t &size, int64_t &mtime);
+
+  /**
+   * @brief write sidecar for an imported fabric
+   * @param source path to source file the fabric was imported from
+   * @param fabric fabric imported from source
+   * @return true if sidecar was written
+   */
+  static bool write(const std::string &source, const tulip_fabric_t &fabric);
+
+  /**
+   * @brief map sidecar of source file
+   * @return true if sidecar exists and matches source file
+   */
+  bool open(const std::string &source);
+
+  /**
+   * @brief unmap sidecar
+   */
+  void close();
+
+  bool is_open() const { return header != NULL; }
+
+  /**
+   * @brief exchange mappings (to keep a sidecar mapped past its opener)
+   */
+  void swap(fabric_cache_t &other);
+
+  /**
+   * @brief check if source file still has the fingerprint of the sidecar
+   */
+  bool matches(const std::string &source) const;
+
+  /**
+   * @brief rebuild the parsed port map from the port records
+   * @param portmap filled with new ports, as from ibnetdiscover_p_t::parse()
+   * @return false if records are inconsistent
+   */
+  bool load_ports(parser::ibnetdiscover_p_t::portmap_t &portmap) const;
+
+  uint32_t entity_count() const { return header->entity_count; }
+  uint32_t cable_count() const { return header->cable_count; }
+  uint32_t port_count() const { return header->port_count; }
+  const entity_record_t &entity(const uint32_t index) const { return entities[index]; }
+  const cable_record_t &cable(const uint32_t index) const { return cables[index]; }
+  const port_record_t &port(const uint32_t index) const { return ports[index]; }
+
+  /**
+   * @brief get string from string table
+   */
+  const char *string(const uint32_t offset) const { return strings + offset; }
+
+private:
+  fabric_cache_t(const fabric_cache_t &);
+  fabric_cache_t &operator=(const fabric_cache_t &);
+
+  /**
+   * @brief check every string offset and record index of mapping
+   */
+  bool validate() const;
+
+  void *mapping;
+  size_t mapping_size;
+  const header_t *header;
+  const entity_record_t *entities;
+  const cable_record_t *cables;
+  const port_record_t *ports;
+  const char *strings;
+};
+
+}
+
+#endif // IB_TULIP_FABRIC_CACHE_H
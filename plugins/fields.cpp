@@ -0,0 +1,93 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include "fields.h"
+#include "fabric.h"
+
+PLUGIN(PopulateInfinibandFields)
+
+static const char * paramHelp[] = {
+  // Field
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "String Collection" ) \
+  HTML_HELP_DEF( "default", "All" ) \
+  HTML_HELP_BODY() \
+  "Field to create or All." \
+  HTML_HELP_CLOSE()
+};
+
+static const char ALL_FIELDS[] = "All";
+
+namespace ib = infiniband;
+
+PopulateInfinibandFields::PopulateInfinibandFields(tlp::PluginContext* context)
+  : tlp::Algorithm(context)
+{
+  std::string fields = ALL_FIELDS;
+  for(size_t i = 0; i < ib::tulip_fabric_t::field_names().size(); ++i)
+    fields += ";" + ib::tulip_fabric_t::field_names()[i];
+
+  addInParameter<tlp::StringCollection>("Field", paramHelp[0], fields);
+}
+
+bool PopulateInfinibandFields::run()
+{
+  assert(graph);
+
+  ib::tulip_fabric_t * const fabric = ib::tulip_fabric_t::find_fabric(graph, false);
+  if(!fabric)
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable find fabric. Make sure to preserve data when importing data.");
+
+    return false;
+  }
+
+  tlp::StringCollection field;
+  dataSet->get("Field", field);
+
+  const std::vector<std::string> &names = ib::tulip_fabric_t::field_names();
+  for(size_t i = 0; i < names.size(); ++i)
+  {
+    if(field.getCurrentString() != ALL_FIELDS && field.getCurrentString() != names[i])
+      continue;
+
+    if(pluginProgress)
+    {
+      pluginProgress->setComment("Populating " + names[i]);
+      pluginProgress->progress(i, names.size());
+    }
+
+    if(!fabric->require_field(names[i]))
+    {
+      if(pluginProgress)
+        pluginProgress->setError("Unable to populate " + names[i]);
+
+      return false;
+    }
+  }
+
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Populating fields complete.");
+    pluginProgress->progress(names.size(), names.size());
+  }
+
+  return true;
+}
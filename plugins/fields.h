@@ -0,0 +1,47 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <tulip/TulipPluginHeaders.h>
+
+#ifndef IB_FIELDS_H
+#define IB_FIELDS_H
+
+/**
+ * @brief Create property fields of a fabric imported with Lazy Fields
+ */
+class PopulateInfinibandFields: public tlp::Algorithm {
+public:
+  PLUGININFORMATION("Infiniband Populate Fields",
+                    "NCAR",
+                    "10/17/26",
+                    "Create property fields of a fabric imported with Lazy Fields from the preserved fabric data.",
+                    "alpha",
+                    "Infiniband")
+
+  PopulateInfinibandFields(tlp::PluginContext* context);
+
+  /**
+   * @brief create requested field(s)
+   */
+  bool run();
+};
+
+#endif // IB_FIELDS_H
@@ -0,0 +1,179 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <stdint.h>
+#include "ibautils/ib_fabric.h"
+
+#ifndef IB_TULIP_FLAT_MAP_H
+#define IB_TULIP_FLAT_MAP_H
+
+namespace infiniband
+{
+
+/**
+ * @brief GUID and port number of a port
+ */
+struct guid_port_t
+{
+  guid_t guid;
+  port_num_t port;
+
+  guid_port_t() : guid(0), port(0) {}
+  guid_port_t(const guid_t &_guid, const port_num_t &_port) : guid(_guid), port(_port) {}
+
+  bool operator==(const guid_port_t &other) const
+  {
+    return guid == other.guid && port == other.port;
+  }
+};
+
+/**
+ * @brief 64 bit mixer (splitmix64 finalizer)
+ * @note GUIDs share vendor prefixes so the low bits must be mixed
+ */
+inline uint64_t hash_mix(uint64_t value)
+{
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31;
+  return value;
+}
+
+struct guid_hash_t
+{
+  uint64_t operator()(const guid_t &guid) const { return hash_mix(guid); }
+};
+
+struct guid_port_hash_t
+{
+  uint64_t operator()(const guid_port_t &key) const
+  {
+    return hash_mix(key.guid ^ (static_cast<uint64_t>(key.port) << 56 | key.port));
+  }
+};
+
+/**
+ * @brief Open addressing hash map with linear probing
+ *
+ * Keys and values are stored inline in one array so a lookup is a
+ * single probe in the common case. Only insertion is supported,
+ * which is all the fabric indexes need.
+ */
+template<typename Key, typename Value, typename Hash>
+class flat_map_t
+{
+public:
+  flat_map_t() : count(0) {}
+
+  size_t size() const { return count; }
+  bool empty() const { return !count; }
+
+  void clear()
+  {
+    slots.clear();
+    count = 0;
+  }
+
+  /**
+   * @brief insert or replace value of key
+   */
+  void insert(const Key &key, const Value &value)
+  {
+    ///keep load at or below 1/2
+    if((count + 1) * 2 > slots.size())
+      grow();
+
+    slot_t &slot = probe(key);
+    if(!slot.used)
+    {
+      slot.used = true;
+      slot.key = key;
+      ++count;
+    }
+
+    slot.value = value;
+  }
+
+  /**
+   * @brief find value of key
+   * @return value or NULL if key is not in map
+   */
+  const Value *find(const Key &key) const
+  {
+    if(slots.empty())
+      return NULL;
+
+    const size_t mask = slots.size() - 1;
+    for(size_t i = Hash()(key) & mask;; i = (i + 1) & mask)
+    {
+      const slot_t &slot = slots[i];
+      if(!slot.used)
+        return NULL;
+      if(slot.key == key)
+        return &slot.value;
+    }
+  }
+
+private:
+  struct slot_t
+  {
+    Key key;
+    Value value;
+    bool used;
+
+    slot_t() : key(), value(), used(false) {}
+  };
+
+  slot_t &probe(const Key &key)
+  {
+    assert(!slots.empty());
+
+    const size_t mask = slots.size() - 1;
+    for(size_t i = Hash()(key) & mask;; i = (i + 1) & mask)
+    {
+      slot_t &slot = slots[i];
+      if(!slot.used || slot.key == key)
+        return slot;
+    }
+  }
+
+  void grow()
+  {
+    std::vector<slot_t> old;
+    old.swap(slots);
+    slots.resize(old.empty() ? 16 : old.size() * 2);
+
+    for(size_t i = 0; i < old.size(); ++i)
+      if(old[i].used)
+        probe(old[i].key) = old[i];
+  }
+
+  std::vector<slot_t> slots;
+  size_t count;
+};
+
+}
+
+#endif // IB_TULIP_FLAT_MAP_H
@@ -0,0 +1,357 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <cassert>
+#include "forwarding.h"
+
+namespace ib = infiniband;
+
+const ib::forwarding_t::index_t ib::forwarding_t::INVALID_INDEX;
+const int ib::forwarding_t::NO_ROUTE;
+
+ib::forwarding_t::forwarding_t(const ib::tulip_fabric_t &_fabric)
+  : fabric(_fabric)
+{
+  /**
+   * dense index of every entity with a node
+   */
+  entities.reserve(fabric.entity_nodes.size());
+  nodes.reserve(fabric.entity_nodes.size());
+  for(
+    ib::tulip_fabric_t::entity_nodes_t::const_iterator
+      itr = fabric.entity_nodes.begin(),
+      eitr = fabric.entity_nodes.end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    if(itr->second.id >= node_index.size())
+      node_index.resize(itr->second.id + 1, INVALID_INDEX);
+
+    node_index[itr->second.id] = static_cast<index_t>(entities.size());
+    entities.push_back(itr->first);
+    nodes.push_back(itr->second);
+  }
+
+  /**
+   * LID -> entity
+   */
+  size_t lid_count = 0;
+  for(index_t i = 0; i < size(); ++i)
+    for(
+      ib::entity_t::portmap_t::const_iterator
+        pitr = entities[i]->ports.begin(),
+        peitr = entities[i]->ports.end();
+      pitr != peitr;
+      ++pitr
+    )
+      lid_count = std::max<size_t>(lid_count, static_cast<size_t>(pitr->second->lid) + 1);
+
+  lid_entities.assign(lid_count, INVALID_INDEX);
+  for(index_t i = 0; i < size(); ++i)
+    for(
+      ib::entity_t::portmap_t::const_iterator
+        pitr = entities[i]->ports.begin(),
+        peitr = entities[i]->ports.end();
+      pitr != peitr;
+      ++pitr
+    )
+      lid_entities[pitr->second->lid] = i;
+
+  /**
+   * next hop per port and the LFT of every switch
+   */
+  port_offsets.assign(size() + 1, 0);
+  tables.assign(size(), NULL);
+  uplink.assign(size(), 0);
+
+  for(index_t i = 0; i < size(); ++i)
+  {
+    const ib::entity_t &entity = *entities[i];
+    const size_t max_port = entity.ports.empty() ? 0 : entity.ports.rbegin()->first;
+    port_offsets[i + 1] = port_offsets[i] + max_port + 1;
+  }
+
+  const hop_t none = { INVALID_INDEX, tlp::edge() };
+  port_hops.assign(port_offsets.back(), none);
+
+  for(index_t i = 0; i < size(); ++i)
+  {
+    const ib::entity_t &entity = *entities[i];
+
+    for(
+      ib::entity_t::portmap_t::const_iterator
+        pitr = entity.ports.begin(),
+        peitr = entity.ports.end();
+      pitr != peitr;
+      ++pitr
+    )
+    {
+      const ib::port_t * const port = pitr->second;
+      if(!port->connection)
+        continue;
+
+      const ib::tulip_fabric_t::port_slot_t * const edge_slot = fabric.find_port_edge(port->guid, port->port);
+      const ib::tulip_fabric_t::entity_slot_t * const peer_slot = fabric.find_entity_node(port->connection->guid);
+      if(!edge_slot || !peer_slot)
+        continue;
+
+      hop_t &hop = port_hops[port_offsets[i] + pitr->first];
+      hop.entity = index(peer_slot->node);
+      hop.edge = edge_slot->edge;
+
+      if(!uplink[i])
+        uplink[i] = pitr->first;
+    }
+
+    /**
+     * switches have LFTs, everything else forwards via uplink
+     */
+    tables[i] = fabric.lft.find(entity.guid);
+  }
+}
+
+ib::forwarding_t::hop_t ib::forwarding_t::next(const index_t from, const ib::lid_t lid) const
+{
+  const hop_t none = { INVALID_INDEX, tlp::edge() };
+
+  size_t port = uplink[from];
+  if(tables[from])
+    port = lid < tables[from]->size() ? (*tables[from])[lid] : 0;
+
+  if(!port || port_offsets[from] + port >= port_offsets[from + 1])
+    return none;
+
+  return port_hops[port_offsets[from] + port];
+}
+
+void ib::forwarding_t::hops_to(const index_t destination, std::vector<int> &hops) const
+{
+  static const int UNKNOWN = -2;
+  static const int WALKING = -3;
+
+  const ib::lid_t lid = entities[destination]->lid();
+
+  hops.assign(size(), UNKNOWN);
+  hops[destination] = 0;
+
+  /**
+   * walk every unresolved entity until a resolved one is hit,
+   * then unwind the walk assigning hop counts
+   */
+  std::vector<index_t> stack;
+  for(index_t i = 0; i < size(); ++i)
+  {
+    if(hops[i] != UNKNOWN)
+      continue;
+
+    index_t current = i;
+    while(current != INVALID_INDEX && hops[current] == UNKNOWN)
+    {
+      hops[current] = WALKING;
+      stack.push_back(current);
+      current = next(current, lid).entity;
+    }
+
+    ///loop or dead end
+    int base = NO_ROUTE;
+    if(current != INVALID_INDEX && hops[current] >= 0)
+      base = hops[current];
+
+    while(!stack.empty())
+    {
+      if(base != NO_ROUTE)
+        ++base;
+
+      hops[stack.back()] = base;
+      stack.pop_back();
+    }
+  }
+}
+
+double ib::forwarding_t::load_to(const index_t destination, std::vector<double> &load, std::vector<double> &edge_load) const
+{
+  assert(load.size() == size());
+
+  const ib::lid_t lid = entities[destination]->lid();
+
+  std::vector<int> hops;
+  hops_to(destination, hops);
+
+  /**
+   * bucket entities by distance to order them farthest first
+   */
+  int max_hops = 0;
+  for(index_t i = 0; i < size(); ++i)
+    max_hops = std::max(max_hops, hops[i]);
+
+  std::vector<index_t> offsets(max_hops + 2, 0);
+  for(index_t i = 0; i < size(); ++i)
+    if(hops[i] > 0)
+      ++offsets[hops[i] + 1];
+  for(size_t i = 1; i < offsets.size(); ++i)
+    offsets[i] += offsets[i - 1];
+
+  std::vector<index_t> order(offsets.back());
+  for(index_t i = 0; i < size(); ++i)
+    if(hops[i] > 0)
+      order[offsets[hops[i]]++] = i;
+
+  double unrouted = 0;
+  for(index_t i = 0; i < size(); ++i)
+    if(hops[i] == NO_ROUTE)
+    {
+      unrouted += load[i];
+      load[i] = 0;
+    }
+
+  for(size_t i = order.size(); i-- > 0;)
+  {
+    const index_t current = order[i];
+    if(!load[current])
+      continue;
+
+    const hop_t hop = next(current, lid);
+    assert(hop.entity != INVALID_INDEX);
+    assert(hop.edge.id < edge_load.size());
+
+    edge_load[hop.edge.id] += load[current];
+    load[hop.entity] += load[current];
+    load[current] = 0;
+  }
+
+  load[destination] = 0;
+  return unrouted;
+}
+
+int ib::forwarding_t::hops_between(const index_t source, const index_t destination) const
+{
+  const ib::lid_t lid = entities[destination]->lid();
+
+  int count = 0;
+  for(index_t current = source; current != destination; ++count)
+  {
+    if(current == INVALID_INDEX || static_cast<index_t>(count) >= size())
+      return NO_ROUTE;
+
+    current = next(current, lid).entity;
+  }
+
+  return count;
+}
+
+int ib::forwarding_t::trace(const index_t source, const index_t destination, std::vector<tlp::edge> &edges) const
+{
+  const ib::lid_t lid = entities[destination]->lid();
+
+  int count = 0;
+  for(index_t current = source; current != destination; ++count)
+  {
+    if(static_cast<index_t>(count) >= size())
+      return NO_ROUTE;
+
+    const hop_t hop = next(current, lid);
+    if(hop.entity == INVALID_INDEX)
+      return NO_ROUTE;
+
+    edges.push_back(hop.edge);
+    current = hop.entity;
+  }
+
+  return count;
+}
+
+void ib::forwarding_t::hops_from(const index_t source, std::vector<int> &hops, unsigned int threads) const
+{
+  hops.assign(size(), NO_ROUTE);
+
+  if(!threads)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min<unsigned int>(threads, std::max<index_t>(size(), 1));
+
+  /**
+   * every destination is independent: split them in ranges
+   */
+  const index_t chunk = (size() + threads - 1) / threads;
+  std::vector<std::thread> pool;
+
+  for(unsigned int t = 0; t < threads; ++t)
+  {
+    const index_t first = std::min<index_t>(size(), t * chunk);
+    const index_t last = std::min<index_t>(size(), first + chunk);
+
+    pool.push_back(std::thread([this, source, first, last, &hops]()
+    {
+      for(index_t destination = first; destination < last; ++destination)
+        hops[destination] = hops_between(source, destination);
+    }));
+  }
+
+  for(size_t t = 0; t < pool.size(); ++t)
+    pool[t].join();
+}
+
+ib::endpoints_t::endpoints_t(const ib::forwarding_t &forwarding)
+{
+  typedef ib::entity_t l;
+
+  for(ib::forwarding_t::index_t i = 0; i < forwarding.size(); ++i)
+  {
+    const ib::entity_t &entity = *forwarding.entity(i);
+    guids.insert(std::make_pair(entity.guid, i));
+
+    ///first entity wins on duplicate names
+    const std::string name = entity.label(l::LABEL_NAME_ONLY);
+    if(name.empty())
+      continue;
+
+    names.insert(std::make_pair(name, i));
+
+    const std::string::size_type space = name.find_first_of(" \t");
+    if(space != std::string::npos && space > 0)
+      names.insert(std::make_pair(name.substr(0, space), i));
+  }
+}
+
+ib::forwarding_t::index_t ib::endpoints_t::find(const std::string &name) const
+{
+  const std::string::size_type first = name.find_first_not_of(" \t\"");
+  const std::string::size_type last = name.find_last_not_of(" \t\"\r");
+  if(first == std::string::npos)
+    return ib::forwarding_t::INVALID_INDEX;
+
+  const std::string key = name.substr(first, last - first + 1);
+
+  if(key.size() > 2 && key[0] == '0' && (key[1] == 'x' || key[1] == 'X'))
+  {
+    char *end = NULL;
+    const ib::guid_t guid = strtoull(key.c_str(), &end, 16);
+    if(end && !*end)
+    {
+      const guids_t::const_iterator itr = guids.find(guid);
+      return itr == guids.end() ? ib::forwarding_t::INVALID_INDEX : itr->second;
+    }
+  }
+
+  const names_t::const_iterator itr = names.find(key);
+  return itr == names.end() ? ib::forwarding_t::INVALID_INDEX : itr->second;
+}
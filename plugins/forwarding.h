@@ -0,0 +1,200 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <tulip/TulipPluginHeaders.h>
+#include "fabric.h"
+
+#ifndef IB_TULIP_FORWARDING_H
+#define IB_TULIP_FORWARDING_H
+
+namespace infiniband
+{
+
+/**
+ * @brief Forwarding engine over the linear forwarding tables of a fabric
+ *
+ * For a given destination LID every switch has exactly one egress port,
+ * so the LFTs of all switches form a tree rooted at the destination
+ * (HCAs forward to the switch they are cabled to). Instead of tracing the
+ * LFT path independently for every (source, destination) pair, the tree
+ * of a destination is resolved once with every entity's hop count
+ * memoized, which answers all sources in one O(V) sweep.
+ *
+ * Entities are addressed by a dense index. Paths that loop or hit a
+ * switch without a route for the LID report NO_ROUTE.
+ */
+class forwarding_t
+{
+public:
+  typedef uint32_t index_t;
+
+  static const index_t INVALID_INDEX = ~static_cast<index_t>(0);
+
+  /**
+   * @brief hop count of entities without a route to the destination
+   */
+  static const int NO_ROUTE = -1;
+
+  /**
+   * @brief next hop of an entity towards a destination
+   */
+  struct hop_t
+  {
+    index_t entity;
+    tlp::edge edge;
+  };
+
+  forwarding_t(const tulip_fabric_t &_fabric);
+
+  /**
+   * @brief number of entities
+   */
+  index_t size() const { return static_cast<index_t>(entities.size()); }
+
+  /**
+   * @brief get dense index of entity node
+   */
+  index_t index(const tlp::node &node) const
+  {
+    return node.id < node_index.size() ? node_index[node.id] : INVALID_INDEX;
+  }
+
+  const tlp::node &node(const index_t index) const { return nodes[index]; }
+  const entity_t *entity(const index_t index) const { return entities[index]; }
+
+  /**
+   * @brief get entity owning LID or INVALID_INDEX
+   */
+  index_t lid_entity(const lid_t lid) const
+  {
+    return lid < lid_entities.size() ? lid_entities[lid] : INVALID_INDEX;
+  }
+
+  /**
+   * @brief next hop of entity towards LID
+   * @return hop or hop with entity=INVALID_INDEX if there is no route
+   */
+  hop_t next(const index_t from, const lid_t lid) const;
+
+  /**
+   * @brief hops of every entity to destination (per destination tree)
+   * @param destination dense index of destination entity
+   * @param hops set to hops per entity or NO_ROUTE
+   */
+  void hops_to(const index_t destination, std::vector<int> &hops) const;
+
+  /**
+   * @brief push traffic of every source along the tree of destination
+   *
+   * Entities are visited farthest first so each one forwards its own
+   * traffic plus everything it received in a single step: O(V) per
+   * destination no matter how many sources send to it.
+   *
+   * @param destination dense index of destination entity
+   * @param load bytes sent by every entity to destination (consumed)
+   * @param edge_load bytes are added per edge.id (must cover all edges)
+   * @return bytes without a route to destination
+   */
+  double load_to(const index_t destination, std::vector<double> &load, std::vector<double> &edge_load) const;
+
+  /**
+   * @brief hops from source to one destination (source rooted walk)
+   */
+  int hops_between(const index_t source, const index_t destination) const;
+
+  /**
+   * @brief follow the LFTs from source to destination
+   * @param source dense index of source entity
+   * @param destination dense index of destination entity
+   * @param edges every traversed edge is appended
+   * @return hops or NO_ROUTE (edges of a partial walk are still appended)
+   */
+  int trace(const index_t source, const index_t destination, std::vector<tlp::edge> &edges) const;
+
+  /**
+   * @brief hops from source to every entity
+   *
+   * Destinations are independent so they are split over threads.
+   *
+   * @param source dense index of source entity
+   * @param hops set to hops per destination or NO_ROUTE
+   * @param threads number of threads (0 for hardware concurrency)
+   */
+  void hops_from(const index_t source, std::vector<int> &hops, unsigned int threads) const;
+
+private:
+  const tulip_fabric_t &fabric;
+
+  std::vector<const entity_t*> entities;
+  std::vector<tlp::node> nodes;
+  std::vector<index_t> node_index;
+  std::vector<index_t> lid_entities;
+
+  /**
+   * @brief next hop per (entity, port number)
+   * @note ports of entity i are at [port_offsets[i], port_offsets[i+1])
+   */
+  std::vector<size_t> port_offsets;
+  std::vector<hop_t> port_hops;
+
+  /**
+   * @brief LFT of entity i or NULL for HCAs
+   */
+  std::vector<const lft_t::row_t*> tables;
+
+  /**
+   * @brief port HCAs forward everything through
+   */
+  std::vector<uint8_t> uplink;
+};
+
+/**
+ * @brief resolve user given endpoint names to forwarding indexes
+ *
+ * Accepts a hex GUID (0x...), the entity name (ibName) or the first
+ * word of the entity name, which is the hostname for HCAs.
+ */
+class endpoints_t
+{
+public:
+  endpoints_t(const forwarding_t &forwarding);
+
+  /**
+   * @brief find entity by GUID or name
+   * @return dense index or forwarding_t::INVALID_INDEX
+   */
+  forwarding_t::index_t find(const std::string &name) const;
+
+private:
+  typedef std::map<guid_t, forwarding_t::index_t> guids_t;
+  typedef std::map<std::string, forwarding_t::index_t> names_t;
+
+  guids_t guids;
+  names_t names;
+};
+
+}
+
+#endif // IB_TULIP_FORWARDING_H
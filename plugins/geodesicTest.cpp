@@ -32,6 +32,7 @@
 #include <tulip/Algorithm.h>
 
 #include "geodesicTest.h"
+#include "paths.h"
 #include "shortestPath.h"
 
 #include "fabric.h"
@@ -49,86 +50,6 @@ geodesicTest::geodesicTest(tlp::PluginContext* context)
 {
 }
 
-//
-//
-//TODO: All functions besides bool geodesicTest::run() are copied from geodesicTest.h
-//It would be better to call that plugin and use its output
-//
-//
-
-    //Find minimum distance between two nodes
-int geodesicTest::nodes_map::min_distance(map<int, geodesicTest::nodes_map::myNode*> map1, bool visited[]){
-    int min = INT_MAX;
-    int min_index = 0;
-
-    for(int i = 0; i<v; i++){
-        if(!visited[i] && map1[i]->getDist() < min)
-            min = map1[i]->getDist(), min_index = i;
-    }
-
-    return min_index;
-}
-
-//Dijkstra algorithm
-map<int,geodesicTest::nodes_map::myNode*> geodesicTest::nodes_map::dijkstra(int src) {
-    map<int, geodesicTest::nodes_map::myNode*> distmap;
-    bool visited[v];
-
-    for (int i = 0; i < v; i++) {
-        distmap[i] = new geodesicTest::nodes_map::myNode(i, INT_MAX);
-        visited[i] = false;
-    }
-    distmap[src]->setDist(0);
-
-    for (int count = 0; count < v - 1; count++) {
-        int u = min_distance(distmap, visited);
-        visited[u] = true;
-
-        for (int i = 0; i < v; i++) {
-            if (!visited[i] && adjacent_matrix[u][i] && distmap[u]->getDist() != INT_MAX &&
-                distmap[u]->getDist() + adjacent_matrix[u][i] < distmap[i]->getDist())
-            {
-                distmap[i]->setDist(distmap[u]->getDist() + adjacent_matrix[u][i]);
-                distmap[i]->setFrom(u);
-            }
-        }
-    }
-
-    return distmap;
-}
-
-vector<unsigned int> geodesicTest::nodes_map::tracePath(map<int, geodesicTest::nodes_map::myNode*> distmap, int target, int src){
-    vector<unsigned int> path;
-    unsigned int pos = target;
-    for(int i = 0; i<v-1; i++){
-        path.push_back(pos);
-        pos = distmap[pos]->getFrom();
-        if(pos == (unsigned int)src){
-            path.push_back(pos);
-            break;
-        }
-    }
-
-    return path;
-}
-
-//Find node from its id
-const tlp::node & geodesicTest::find_node(unsigned int id){
-    tlp::Iterator<tlp::node> *itnodes = graph->getNodes();
-
-    while(itnodes->hasNext()){
-        const tlp::node &node = itnodes->next();
-        if(node.id == id)
-            return node;
-    }
-
-    itnodes = graph->getNodes();
-    const tlp::node &temp = itnodes->next();
-    delete itnodes;
-    return temp;
-}
-
-
 //Tulip's main function
 bool geodesicTest::run()
 {
@@ -240,9 +161,6 @@ bool geodesicTest::run()
     //
     
     
-    //Store the total number of nodes
-    int v = graph->numberOfNodes(); 
-    
     tlp::Iterator<node> *selectedNodes = select->getNodesEqualTo(true,NULL);
     
     int path_node[2]; //an array to store source and destination node ids
@@ -277,18 +195,40 @@ bool geodesicTest::run()
     if(pluginProgress)
     {
         pluginProgress->progress(1, STEPS);
-        pluginProgress->setComment("Applying Dijkstra's algorithm to source node.");
+        pluginProgress->setComment("Applying BFS to source node.");
     }
 
 
-    //Apply Dijkstra's algorithm from source node
-    nodes_map *graphAnalysis = new nodes_map(graph,v);
-    map<int, geodesicTest::nodes_map::myNode*> mymap = graphAnalysis->dijkstra(path_node[0]);
+    //Apply BFS from source node over the shared adjacency snapshot
+    const infiniband::adjacency_t &adjacency = infiniband::adjacency_t::find(graph);
+    const infiniband::adjacency_t::index_t source = adjacency.index(tlp::node(path_node[0]));
+    const infiniband::adjacency_t::index_t target = adjacency.index(tlp::node(path_node[1]));
+    if(source == infiniband::adjacency_t::INVALID_INDEX || target == infiniband::adjacency_t::INVALID_INDEX)
+    {
+      if(pluginProgress)
+        pluginProgress->setError("Selected nodes are not part of the graph");
+
+      return false;
+    }
+
+    infiniband::shortest_paths_t paths(adjacency);
+    paths.bfs(source);
 
     //Vector to store path edge indices
     std::vector<unsigned int> mypath;
 
-    mypath = graphAnalysis->tracePath(mymap,path_node[1],path_node[0]);
+    const std::vector<infiniband::adjacency_t::index_t> trace = paths.trace(target);
+    for(size_t i = 0; i<trace.size(); i++)
+        mypath.push_back(adjacency.node(trace[i]).id);
+
+    //If the nodes are not connected show an error
+    if(mypath.empty())
+    {
+      if(pluginProgress)
+        pluginProgress->setError("No path between the selected nodes");
+
+      return false;
+    }
 
     int length = mypath.size()-1;
     
@@ -0,0 +1,126 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <map>
+#include <tulip/DoubleProperty.h>
+#include "history.h"
+#include "fabric.h"
+
+PLUGIN(InfinibandMetricHistory)
+
+static const char * paramHelp[] = {
+  // Field
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "string" ) \
+  HTML_HELP_DEF( "default", "ibMetric" ) \
+  HTML_HELP_BODY() \
+  "Field imported with History Samples. Creates <field>Min, <field>Max, <field>Mean and <field>P95." \
+  HTML_HELP_CLOSE(),
+
+  // Samples
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_BODY() \
+  "Number of retained imports aggregated." \
+  HTML_HELP_CLOSE()
+};
+
+namespace ib = infiniband;
+
+InfinibandMetricHistory::InfinibandMetricHistory(tlp::PluginContext* context)
+  : tlp::Algorithm(context)
+{
+  addInParameter<std::string>("Field", paramHelp[0], "ibMetric");
+  addOutParameter<int>("Samples", paramHelp[1]);
+}
+
+bool InfinibandMetricHistory::run()
+{
+  assert(graph);
+
+  ib::tulip_fabric_t * const fabric = ib::tulip_fabric_t::find_fabric(graph, false);
+  if(!fabric)
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable find fabric. Make sure to preserve data when importing data.");
+
+    return false;
+  }
+
+  std::string field;
+  dataSet->get("Field", field);
+
+  const std::map<std::string, ib::metric_series_t>::const_iterator series = fabric->series.find(field);
+  if(series == fabric->series.end() || !series->second.size())
+  {
+    if(pluginProgress)
+      pluginProgress->setError("No history of " + field + ". Import it with History Samples first.");
+
+    return false;
+  }
+
+  tlp::DoubleProperty * const ibMin = graph->getProperty<tlp::DoubleProperty>(field + "Min");
+  tlp::DoubleProperty * const ibMax = graph->getProperty<tlp::DoubleProperty>(field + "Max");
+  tlp::DoubleProperty * const ibMean = graph->getProperty<tlp::DoubleProperty>(field + "Mean");
+  tlp::DoubleProperty * const ibP95 = graph->getProperty<tlp::DoubleProperty>(field + "P95");
+  assert(ibMin && ibMax && ibMean && ibP95);
+
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Aggregating history of " + field);
+    pluginProgress->progress(0, 1);
+  }
+
+  tlp::Observable::holdObservers();
+  for(
+    ib::tulip_fabric_t::port_edges_t::const_iterator
+      itr = fabric->port_edges.begin(),
+      eitr = fabric->port_edges.end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    ///never leave aggregates of an earlier run on an edge without samples
+    ib::metric_series_t::aggregate_t aggregate;
+    if(!series->second.aggregate(itr->second, aggregate))
+    {
+      ibMin->setEdgeValue(itr->second, ibMin->getEdgeDefaultValue());
+      ibMax->setEdgeValue(itr->second, ibMax->getEdgeDefaultValue());
+      ibMean->setEdgeValue(itr->second, ibMean->getEdgeDefaultValue());
+      ibP95->setEdgeValue(itr->second, ibP95->getEdgeDefaultValue());
+      continue;
+    }
+
+    ibMin->setEdgeValue(itr->second, aggregate.min);
+    ibMax->setEdgeValue(itr->second, aggregate.max);
+    ibMean->setEdgeValue(itr->second, aggregate.mean);
+    ibP95->setEdgeValue(itr->second, aggregate.p95);
+  }
+  tlp::Observable::unholdObservers();
+
+  dataSet->set("Samples", static_cast<int>(series->second.size()));
+
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Aggregating history complete.");
+    pluginProgress->progress(1, 1);
+  }
+
+  return true;
+}
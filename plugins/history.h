@@ -0,0 +1,47 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <tulip/TulipPluginHeaders.h>
+
+#ifndef IB_HISTORY_H
+#define IB_HISTORY_H
+
+/**
+ * @brief Export window aggregates of a metric retained by the CSV importer
+ */
+class InfinibandMetricHistory: public tlp::Algorithm {
+public:
+  PLUGININFORMATION("Infiniband Metric History",
+                    "NCAR",
+                    "10/17/26",
+                    "Create min, max, mean and 95th percentile properties of a field over the imports retained with History Samples.",
+                    "alpha",
+                    "Infiniband")
+
+  InfinibandMetricHistory(tlp::PluginContext* context);
+
+  /**
+   * @brief aggregate retained samples of every edge
+   */
+  bool run();
+};
+
+#endif // IB_HISTORY_H
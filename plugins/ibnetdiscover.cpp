@@ -0,0 +1,277 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <istream>
+#include <map>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ibnetdiscover.h"
+#include "input_stream.h"
+
+namespace ib = infiniband;
+namespace ibp = infiniband::parser;
+
+/**
+ * @brief files smaller than this per thread are not worth splitting
+ */
+static const size_t MIN_CHUNK = 4 * 1024 * 1024;
+
+/**
+ * @brief bytes handed to a parser at once, the cancel flag is checked
+ * between windows (it is raised from progress polled every 50 ms, whose
+ * state is only refreshed every 100 ms)
+ */
+static const size_t WINDOW = 1024 * 1024;
+
+/**
+ * @brief read only stream over part of the mapping
+ */
+class chunk_buf_t : public std::streambuf
+{
+public:
+  chunk_buf_t(
+    const char * const begin,
+    const char * const _end,
+    std::atomic<size_t> &_consumed,
+    const std::atomic<bool> &_cancel
+  ) :
+    next(begin),
+    end(_end),
+    consumed(_consumed),
+    cancel(_cancel)
+  {
+  }
+
+  ~chunk_buf_t()
+  {
+    consumed += egptr() - eback();
+  }
+
+protected:
+  int_type underflow()
+  {
+    if(gptr() < egptr())
+      return traits_type::to_int_type(*gptr());
+
+    consumed += egptr() - eback();
+
+    ///cancelled parsers just see the end of the chunk
+    if(next == end || cancel)
+      return traits_type::eof();
+
+    char * const window = const_cast<char *>(next);
+    next += std::min<size_t>(WINDOW, end - next);
+    setg(window, window, const_cast<char *>(next));
+
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  const char *next;
+  const char * const end;
+  std::atomic<size_t> &consumed;
+  const std::atomic<bool> &cancel;
+};
+
+/**
+ * @brief move ports of source into target
+ * @param duplicates port of source -> equal port already in target
+ */
+static void merge_ports(
+  ibp::ibnetdiscover_p_t::portmap_t &target,
+  ibp::ibnetdiscover_p_t::portmap_t &source,
+  std::map<ib::port_t*, ib::port_t*> &duplicates
+)
+{
+  for(
+    ibp::ibnetdiscover_p_t::portmap_t::iterator
+      itr = source.begin(),
+      eitr = source.end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    std::pair<ibp::ibnetdiscover_p_t::portmap_t::iterator, bool> result = target.insert(*itr);
+    if(result.second)
+      continue;
+
+    ///remote end seen before the line of the port itself
+    ib::port_t * const kept = result.first->second;
+    if(!kept->connection)
+      kept->connection = itr->second->connection;
+
+    duplicates[itr->second] = kept;
+  }
+
+  source.clear();
+}
+
+bool ib::parse_ibnetdiscover_p(
+  const std::string &filename,
+  ibp::ibnetdiscover_p_t::portmap_t &portmap,
+  unsigned int threads,
+  const ib::progress_t &progress
+)
+{
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  const size_t size = st.st_size;
+
+  if(!threads)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::max<size_t>(1, std::min<size_t>(threads, size / MIN_CHUNK));
+
+  /**
+   * single chunk or compressed dump (which can not be split): parse
+   * as one stream while a reader thread reads (and decompresses)
+   * ahead of the parser
+   */
+  if(threads == 1 || ib::detect_compression(filename) != ib::COMPRESSION_NONE)
+  {
+    ::close(fd);
+
+    ib::input_stream_t input;
+    if(!input.open(filename))
+      return false;
+
+    input.set_progress(progress);
+
+    std::istream is(&input);
+    ibp::ibnetdiscover_p_t parser;
+    return parser.parse(portmap, is) && !input.failed() && !input.cancelled();
+  }
+
+  void * const mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if(mapping == MAP_FAILED)
+    return false;
+
+  madvise(mapping, size, MADV_SEQUENTIAL);
+
+  /**
+   * split at the first newline after every even cut
+   */
+  const char * const data = static_cast<const char *>(mapping);
+  std::vector<const char *> cuts(1, data);
+  for(unsigned int t = 1; t < threads; ++t)
+  {
+    const char *cut = std::max(cuts.back(), data + size / threads * t);
+    const char * const newline = static_cast<const char *>(memchr(cut, '\n', data + size - cut));
+    cut = newline ? newline + 1 : data + size;
+
+    if(cut > cuts.back() && cut < data + size)
+      cuts.push_back(cut);
+  }
+  cuts.push_back(data + size);
+
+  const size_t chunks = cuts.size() - 1;
+  std::vector<ibp::ibnetdiscover_p_t::portmap_t> portmaps(chunks);
+  std::vector<char> parsed(chunks, false);
+  std::vector<std::thread> pool;
+
+  std::atomic<size_t> consumed(0);
+  std::atomic<size_t> running(chunks);
+  std::atomic<bool> cancel(false);
+
+  for(size_t c = 0; c < chunks; ++c)
+    pool.push_back(std::thread([c, &cuts, &portmaps, &parsed, &consumed, &running, &cancel]()
+    {
+      {
+        chunk_buf_t buffer(cuts[c], cuts[c + 1], consumed, cancel);
+        std::istream is(&buffer);
+
+        ibp::ibnetdiscover_p_t parser;
+        parsed[c] = parser.parse(portmaps[c], is);
+      }
+
+      --running;
+    }));
+
+  /**
+   * report progress of all chunks from calling thread
+   */
+  if(progress)
+    while(running)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      if(!cancel && !progress(consumed, size))
+        cancel = true;
+    }
+
+  for(size_t t = 0; t < pool.size(); ++t)
+    pool[t].join();
+
+  munmap(mapping, size);
+
+  /**
+   * merge in file order so the first occurrence of a port is kept
+   */
+  bool success = !cancel;
+  std::map<ib::port_t*, ib::port_t*> duplicates;
+  for(size_t c = 0; c < chunks; ++c)
+  {
+    success = success && parsed[c];
+    merge_ports(portmap, portmaps[c], duplicates);
+  }
+
+  if(!duplicates.empty())
+  {
+    for(
+      ibp::ibnetdiscover_p_t::portmap_t::iterator
+        itr = portmap.begin(),
+        eitr = portmap.end();
+      itr != eitr;
+      ++itr
+    )
+    {
+      const std::map<ib::port_t*, ib::port_t*>::const_iterator ditr = duplicates.find(itr->second->connection);
+      if(ditr != duplicates.end())
+        itr->second->connection = ditr->second;
+    }
+
+    for(
+      std::map<ib::port_t*, ib::port_t*>::const_iterator
+        itr = duplicates.begin(),
+        eitr = duplicates.end();
+      itr != eitr;
+      ++itr
+    )
+      delete itr->first;
+  }
+
+  return success;
+}
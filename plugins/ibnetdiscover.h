@@ -0,0 +1,60 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <string>
+#include "ibautils/ib_fabric.h"
+#include "ibautils/ib_parser.h"
+#include "input_stream.h"
+
+#ifndef IB_TULIP_IBNETDISCOVER_H
+#define IB_TULIP_IBNETDISCOVER_H
+
+namespace infiniband
+{
+
+/**
+ * @brief parse ibnetdiscover -p dump using several threads
+ *
+ * The file is mapped and split at line boundaries. Every chunk is parsed
+ * by its own ibnetdiscover_p_t into its own port list. The lists are then
+ * merged: a port that shows up in several chunks (once as a line and
+ * once as the remote end of a cable) is kept once and every connection
+ * is pointed at the kept port.
+ *
+ * Compressed (gzip, zstd) dumps are parsed by one thread while another
+ * decompresses them.
+ *
+ * @param filename path of ibnetdiscover -p dump
+ * @param portmap parsed ports, as from ibnetdiscover_p_t::parse()
+ * @param threads threads to use or 0 for all cores
+ * @param progress called with bytes parsed, returning false cancels parsing
+ * @return false if file can not be read, a chunk fails to parse or cancelled
+ */
+bool parse_ibnetdiscover_p(
+  const std::string &filename,
+  parser::ibnetdiscover_p_t::portmap_t &portmap,
+  unsigned int threads,
+  const progress_t &progress = progress_t()
+);
+
+}
+
+#endif // IB_TULIP_IBNETDISCOVER_H
@@ -0,0 +1,379 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#ifdef IB_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include "input_stream.h"
+
+namespace ib = infiniband;
+
+/**
+ * @brief bytes read from disk and handed to the consumer at once
+ */
+static const size_t READ_BLOCK = 256 * 1024;
+static const size_t OUTPUT_BLOCK = 1024 * 1024;
+
+/**
+ * @brief decompressed blocks buffered ahead of the consumer
+ */
+static const size_t QUEUE_DEPTH = 4;
+
+static const unsigned char GZIP_MAGIC[] = { 0x1f, 0x8b };
+static const unsigned char ZSTD_MAGIC[] = { 0x28, 0xb5, 0x2f, 0xfd };
+
+ib::compression_t ib::detect_compression(const std::string &filename)
+{
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if(fd < 0)
+    return COMPRESSION_NONE;
+
+  unsigned char magic[4] = { 0, 0, 0, 0 };
+  const ssize_t count = read(fd, magic, sizeof(magic));
+  ::close(fd);
+
+  if(count >= static_cast<ssize_t>(sizeof(GZIP_MAGIC)) && !memcmp(magic, GZIP_MAGIC, sizeof(GZIP_MAGIC)))
+    return COMPRESSION_GZIP;
+  if(count >= static_cast<ssize_t>(sizeof(ZSTD_MAGIC)) && !memcmp(magic, ZSTD_MAGIC, sizeof(ZSTD_MAGIC)))
+    return COMPRESSION_ZSTD;
+
+  return COMPRESSION_NONE;
+}
+
+ib::input_stream_t::input_stream_t()
+  : compression(COMPRESSION_NONE), file_size(0), file_offset(0), consumed(0), error(false), finished(true), stopping(false),
+    stopped_by_progress(false)
+{
+}
+
+ib::input_stream_t::~input_stream_t()
+{
+  close();
+}
+
+bool ib::input_stream_t::open(const std::string &filename)
+{
+  close();
+
+  compression = detect_compression(filename);
+#ifndef IB_HAVE_ZSTD
+  if(compression == COMPRESSION_ZSTD)
+  {
+#ifndef NDEBUG
+    std::cerr << "built without zstd support: " << filename << std::endl;
+#endif
+    return false;
+  }
+#endif
+
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  struct stat st;
+  if(fstat(fd, &st) != 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  file_size = st.st_size;
+  file_offset = 0;
+  consumed = 0;
+  error = false;
+  stopped_by_progress = false;
+  finished = false;
+  stopping = false;
+
+  reader = std::thread(&input_stream_t::run, this, fd);
+  return true;
+}
+
+void ib::input_stream_t::close()
+{
+  if(reader.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stopping = true;
+    }
+    changed.notify_all();
+    reader.join();
+  }
+
+  queue.clear();
+  current.clear();
+  finished = true;
+  setg(NULL, NULL, NULL);
+}
+
+bool ib::input_stream_t::push(std::vector<char> &block, const size_t offset)
+{
+  std::unique_lock<std::mutex> guard(lock);
+  while(!stopping && queue.size() >= QUEUE_DEPTH)
+    changed.wait(guard);
+
+  if(stopping)
+    return false;
+
+  queue.push_back(block_t());
+  queue.back().data.swap(block);
+  queue.back().offset = offset;
+  changed.notify_all();
+  return true;
+}
+
+/**
+ * @brief read next chunk of file
+ * @return bytes read, 0 at EOF, -1 on error
+ */
+static ssize_t read_chunk(const int fd, std::vector<char> &buffer)
+{
+  buffer.resize(READ_BLOCK);
+  for(;;)
+  {
+    const ssize_t count = read(fd, &buffer[0], buffer.size());
+    if(count < 0 && errno == EINTR)
+      continue;
+
+    buffer.resize(count > 0 ? count : 0);
+    return count;
+  }
+}
+
+void ib::input_stream_t::run(const int fd)
+{
+  std::vector<char> input;
+  std::vector<char> output;
+  bool success = true;
+
+  switch(compression)
+  {
+    case COMPRESSION_NONE:
+    {
+      for(;;)
+      {
+        const ssize_t count = read_chunk(fd, input);
+        if(count <= 0)
+        {
+          success = !count;
+          break;
+        }
+
+        file_offset += count;
+        if(!push(input, file_offset))
+          break;
+      }
+
+      break;
+    }
+    case COMPRESSION_GZIP:
+    {
+      z_stream z;
+      memset(&z, 0, sizeof(z));
+
+      ///32: detect gzip or zlib header
+      if(inflateInit2(&z, 15 + 32) != Z_OK)
+      {
+        success = false;
+        break;
+      }
+
+      int result = Z_OK;
+      bool ended = false;
+      for(;;)
+      {
+        if(!z.avail_in)
+        {
+          const ssize_t count = read_chunk(fd, input);
+          if(count < 0)
+          {
+            success = false;
+            break;
+          }
+
+          ///truncated unless last member ended
+          if(!count)
+          {
+            success = ended;
+            break;
+          }
+
+          file_offset += count;
+          z.next_in = reinterpret_cast<Bytef *>(&input[0]);
+          z.avail_in = count;
+        }
+
+        ///concatenated members (e.g. from pigz or cat)
+        if(result == Z_STREAM_END)
+        {
+          if(inflateReset(&z) != Z_OK)
+          {
+            success = false;
+            break;
+          }
+          ended = false;
+        }
+
+        output.resize(OUTPUT_BLOCK);
+        z.next_out = reinterpret_cast<Bytef *>(&output[0]);
+        z.avail_out = output.size();
+
+        result = inflate(&z, Z_NO_FLUSH);
+        if(result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+        {
+          success = false;
+          break;
+        }
+
+        if(result == Z_STREAM_END)
+          ended = true;
+
+        output.resize(output.size() - z.avail_out);
+        if(!output.empty() && !push(output, file_offset))
+          break;
+      }
+
+      inflateEnd(&z);
+      break;
+    }
+    case COMPRESSION_ZSTD:
+    {
+#ifdef IB_HAVE_ZSTD
+      ZSTD_DStream * const z = ZSTD_createDStream();
+      if(!z || ZSTD_isError(ZSTD_initDStream(z)))
+      {
+        success = false;
+        if(z)
+          ZSTD_freeDStream(z);
+        break;
+      }
+
+      ZSTD_inBuffer in = { NULL, 0, 0 };
+      size_t hint = 1;
+      for(;;)
+      {
+        if(in.pos == in.size)
+        {
+          const ssize_t count = read_chunk(fd, input);
+          if(count < 0)
+          {
+            success = false;
+            break;
+          }
+
+          ///hint is 0 once a frame is complete
+          if(!count)
+          {
+            success = !hint;
+            break;
+          }
+
+          file_offset += count;
+          in.src = &input[0];
+          in.size = count;
+          in.pos = 0;
+        }
+
+        output.resize(OUTPUT_BLOCK);
+        ZSTD_outBuffer out = { &output[0], output.size(), 0 };
+
+        hint = ZSTD_decompressStream(z, &out, &in);
+        if(ZSTD_isError(hint))
+        {
+          success = false;
+          break;
+        }
+
+        output.resize(out.pos);
+        if(!output.empty() && !push(output, file_offset))
+          break;
+      }
+
+      ZSTD_freeDStream(z);
+#else
+      success = false;
+#endif
+      break;
+    }
+  }
+
+  ::close(fd);
+
+  if(!success)
+    error = true;
+
+  std::lock_guard<std::mutex> guard(lock);
+  finished = true;
+  changed.notify_all();
+}
+
+bool ib::input_stream_t::next_block(const char *&data, size_t &size)
+{
+  if(stopped_by_progress || (progress && !progress(consumed, file_size)))
+  {
+    stopped_by_progress = true;
+    current.clear();
+    return false;
+  }
+
+  std::unique_lock<std::mutex> guard(lock);
+  while(queue.empty() && !finished)
+    changed.wait(guard);
+
+  if(queue.empty())
+  {
+    if(!error)
+      consumed = file_size;
+
+    current.clear();
+    return false;
+  }
+
+  current.swap(queue.front().data);
+  consumed = queue.front().offset;
+  queue.pop_front();
+  changed.notify_all();
+
+  data = &current[0];
+  size = current.size();
+  return true;
+}
+
+ib::input_stream_t::int_type ib::input_stream_t::underflow()
+{
+  if(gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+
+  const char *data = NULL;
+  size_t size = 0;
+  if(!next_block(data, size))
+    return traits_type::eof();
+
+  char * const begin = const_cast<char *>(data);
+  setg(begin, begin, begin + size);
+  return traits_type::to_int_type(*gptr());
+}
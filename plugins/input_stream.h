@@ -0,0 +1,180 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <streambuf>
+#include <functional>
+#include <cstddef>
+
+#ifndef IB_TULIP_INPUT_STREAM_H
+#define IB_TULIP_INPUT_STREAM_H
+
+namespace infiniband
+{
+
+/**
+ * @brief progress callback of parsers
+ * @param done bytes consumed
+ * @param total bytes in total
+ * @return false to cancel
+ */
+typedef std::function<bool (const size_t done, const size_t total)> progress_t;
+
+/**
+ * @brief compression of an input file
+ */
+enum compression_t
+{
+  COMPRESSION_NONE = 0,
+  COMPRESSION_GZIP,
+  COMPRESSION_ZSTD
+};
+
+/**
+ * @brief detect compression from magic bytes of file
+ */
+compression_t detect_compression(const std::string &filename);
+
+/**
+ * @brief Pipelined reader of plain, gzip or zstd files
+ *
+ * A reader thread reads and decompresses the file into a small queue of
+ * blocks while the parser consumes them, either as a std::streambuf
+ * (wrap it in a std::istream) or block by block via next_block().
+ * Decompressed data is never written to disk.
+ */
+class input_stream_t : public std::streambuf
+{
+public:
+  input_stream_t();
+  ~input_stream_t();
+
+  /**
+   * @brief open file and start reader thread
+   * @return false if file can not be opened or its compression is not supported
+   */
+  bool open(const std::string &filename);
+
+  /**
+   * @brief stop reader thread and close file
+   */
+  void close();
+
+  bool is_open() const { return reader.joinable(); }
+
+  /**
+   * @brief get next decompressed block
+   * @note block is valid until the next call
+   * @return false at end of file or on error
+   */
+  bool next_block(const char *&data, size_t &size);
+
+  /**
+   * @brief true if file could not be read or decompressed
+   * @note only final once next_block() returned false
+   */
+  bool failed() const { return error; }
+
+  /**
+   * @brief size of file on disk (compressed)
+   */
+  size_t size() const { return file_size; }
+
+  /**
+   * @brief bytes of file on disk behind the blocks handed out so far
+   */
+  size_t offset() const { return consumed; }
+
+  compression_t get_compression() const { return compression; }
+
+  /**
+   * @brief report bytes of file read before every block handed out
+   * @note called from the consuming thread, returning false ends the stream
+   */
+  void set_progress(const progress_t &callback) { progress = callback; }
+
+  /**
+   * @brief true if stream was ended by progress callback
+   */
+  bool cancelled() const { return stopped_by_progress; }
+
+protected:
+  int_type underflow();
+
+private:
+  input_stream_t(const input_stream_t &);
+  input_stream_t &operator=(const input_stream_t &);
+
+  /**
+   * @brief reader thread
+   */
+  void run(const int fd);
+
+  /**
+   * @brief hand block to consumer, waits while queue is full
+   * @return false if closing
+   */
+  bool push(std::vector<char> &block, const size_t offset);
+
+  compression_t compression;
+  size_t file_size;
+
+  /**
+   * @brief bytes read by reader thread and bytes behind current block
+   */
+  size_t file_offset;
+  size_t consumed;
+
+  std::atomic<bool> error;
+
+  std::thread reader;
+  std::mutex lock;
+  std::condition_variable changed;
+  /**
+   * @brief decompressed data and bytes of file read to produce it
+   */
+  struct block_t
+  {
+    std::vector<char> data;
+    size_t offset;
+  };
+  std::deque<block_t> queue;
+  bool finished;
+  bool stopping;
+
+  /**
+   * @brief block owned by consumer
+   */
+  std::vector<char> current;
+
+  progress_t progress;
+  bool stopped_by_progress;
+};
+
+}
+
+#endif // IB_TULIP_INPUT_STREAM_H
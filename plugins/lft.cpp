@@ -0,0 +1,125 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <string>
+#include <cstring>
+#include "lft.h"
+#include "numbers.h"
+
+namespace ib = infiniband;
+
+static const char HEX_DIGITS[] = "0123456789abcdefABCDEFxX";
+static const char DEC_DIGITS[] = "0123456789";
+
+void ib::lft_t::clear()
+{
+  switches.clear();
+  rows.clear();
+  lids = 0;
+}
+
+const ib::lft_t::row_t *ib::lft_t::find(const ib::guid_t &guid) const
+{
+  const switches_t::const_iterator itr = switches.find(guid);
+  if(itr == switches.end())
+    return NULL;
+
+  return &rows[itr->second];
+}
+
+bool ib::lft_t::parse(std::istream &is)
+{
+  clear();
+
+  /**
+   * Every switch starts with a line ending in "Switch 0x<guid>"
+   * followed by "0x<lid> : <port> ..." lines. Anything else
+   * (comments, column headers) is ignored.
+   */
+  row_t *row = NULL;
+  std::string line;
+  while(std::getline(is, line))
+  {
+    const char * const str = line.c_str();
+    const char *pos = str;
+    while(*pos == ' ' || *pos == '\t')
+      ++pos;
+
+    if(pos[0] == '0' && (pos[1] == 'x' || pos[1] == 'X'))
+    {
+      if(!row)
+        continue;
+
+      uint64_t lid = 0, port = 0;
+      const size_t lid_size = strspn(pos, HEX_DIGITS);
+      if(!ib::parse_hex(pos, lid_size, lid) || lid > static_cast<ib::lid_t>(~0))
+        continue;
+
+      const char * const colon = strchr(pos + lid_size, ':');
+      if(!colon)
+        continue;
+
+      const char *digits = colon + 1;
+      while(*digits == ' ' || *digits == '\t')
+        ++digits;
+
+      if(!ib::parse_uint(digits, strspn(digits, DEC_DIGITS), port) || port > static_cast<ib::port_num_t>(~0))
+        continue;
+
+      if(lid >= row->size())
+        row->resize(lid + 1, 0);
+      (*row)[lid] = static_cast<ib::port_num_t>(port);
+
+      if(lid >= lids)
+        lids = lid + 1;
+
+      continue;
+    }
+
+    const char * const sw = strstr(str, "Switch ");
+    if(!sw)
+      continue;
+
+    const char * const digits = sw + strlen("Switch ");
+    uint64_t guid = 0;
+    if(!ib::parse_hex(digits, strspn(digits, HEX_DIGITS), guid))
+      continue;
+
+    std::pair<switches_t::iterator, bool> result = switches.insert(std::make_pair(guid, rows.size()));
+    if(result.second)
+      rows.push_back(row_t());
+
+    row = &rows[result.first->second];
+  }
+
+  return !switches.empty();
+}
+
+void ib::lft_t::routes(const ib::guid_t &guid, ib::entity_t::routes_t &routes) const
+{
+  routes.clear();
+
+  const row_t * const row = find(guid);
+  if(!row)
+    return;
+
+  for(size_t lid = 0; lid < row->size(); ++lid)
+    if((*row)[lid])
+      routes[(*row)[lid]].insert(static_cast<ib::lid_t>(lid));
+}
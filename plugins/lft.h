@@ -0,0 +1,113 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+#include <istream>
+#include <stdint.h>
+#include "ibautils/ib_fabric.h"
+
+#ifndef IB_TULIP_LFT_H
+#define IB_TULIP_LFT_H
+
+namespace infiniband
+{
+
+/**
+ * @brief Dense linear forwarding tables of every switch
+ *
+ * Parsed straight from ibdiagnet2.fdbs into one byte per (switch, LID)
+ * holding the egress port, 0 meaning no route. Finding the egress port
+ * of a LID is a single load instead of a scan over the port -> LID sets
+ * of entity_t::routes_t, which can be derived with routes() when needed.
+ */
+class lft_t
+{
+public:
+  /**
+   * @brief egress port per LID of a single switch
+   */
+  typedef std::vector<port_num_t> row_t;
+
+  lft_t() : lids(0) {}
+
+  /**
+   * @brief parse ibdiagnet2.fdbs replacing any existing tables
+   * @param is stream to parse
+   * @return true if at least one switch was found
+   */
+  bool parse(std::istream &is);
+
+  /**
+   * @brief remove every table
+   */
+  void clear();
+
+  bool empty() const { return switches.empty(); }
+
+  /**
+   * @brief number of switches with a table
+   */
+  size_t size() const { return switches.size(); }
+
+  /**
+   * @brief one past the highest LID found in any table
+   */
+  size_t lid_count() const { return lids; }
+
+  /**
+   * @brief get table of switch
+   * @param guid switch guid
+   * @return table or NULL if guid has no table
+   */
+  const row_t *find(const guid_t &guid) const;
+
+  /**
+   * @brief get egress port of LID on switch
+   * @return port or 0 if there is no route
+   */
+  port_num_t port(const guid_t &guid, const lid_t &lid) const
+  {
+    const row_t * const row = find(guid);
+    return row && lid < row->size() ? (*row)[lid] : 0;
+  }
+
+  /**
+   * @brief derive the port -> LID set view of a switch table
+   * @param guid switch guid
+   * @param routes cleared then filled in
+   */
+  void routes(const guid_t &guid, entity_t::routes_t &routes) const;
+
+private:
+  typedef std::map<guid_t, size_t> switches_t;
+
+  /**
+   * @brief guid -> index in rows
+   */
+  switches_t switches;
+  std::vector<row_t> rows;
+  size_t lids;
+};
+
+}
+
+#endif // IB_TULIP_LFT_H
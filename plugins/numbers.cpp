@@ -0,0 +1,192 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <cstring>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <tmmintrin.h>
+/**
+ * SSSE3 paths are compiled in regardless of -march and
+ * picked at runtime from cpuid
+ */
+#define IB_SIMD_PARSE __attribute__((target("ssse3")))
+#endif
+#include "numbers.h"
+
+namespace ib = infiniband;
+
+static bool parse_hex_scalar(const char *itr, const char * const end, uint64_t &value)
+{
+  uint64_t result = 0;
+  for(; itr != end; ++itr)
+  {
+    const unsigned char c = *itr;
+    unsigned int digit;
+
+    if(c >= '0' && c <= '9')
+      digit = c - '0';
+    else if((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+      digit = (c | 0x20) - 'a' + 10;
+    else
+      return false;
+
+    result = result << 4 | digit;
+  }
+
+  value = result;
+  return true;
+}
+
+static bool parse_uint_scalar(const char *itr, const char * const end, uint64_t &value)
+{
+  uint64_t result = 0;
+  for(; itr != end; ++itr)
+  {
+    const unsigned int digit = static_cast<unsigned char>(*itr) - '0';
+    if(digit > 9)
+      return false;
+
+    ///overflow
+    if(result > (UINT64_MAX - digit) / 10)
+      return false;
+
+    result = result * 10 + digit;
+  }
+
+  value = result;
+  return true;
+}
+
+#ifdef IB_SIMD_PARSE
+static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+
+/**
+ * @brief convert exactly 16 hex digits
+ */
+IB_SIMD_PARSE static bool parse_hex16(const char * const data, uint64_t &value)
+{
+  const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+
+  ///digits and lower case letters as 0-based offsets, validated unsigned
+  const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  const __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  const __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+  const __m128i is_letter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+
+  if(_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF)
+    return false;
+
+  const __m128i nibbles = _mm_or_si128(
+    _mm_and_si128(is_digit, digits),
+    _mm_andnot_si128(is_digit, _mm_add_epi8(letters, _mm_set1_epi8(10)))
+  );
+
+  ///high nibble * 16 + low nibble, then pack to 8 bytes in string order
+  const __m128i bytes = _mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110));
+  const __m128i packed = _mm_packus_epi16(bytes, bytes);
+
+  uint64_t result;
+  _mm_storel_epi64(reinterpret_cast<__m128i *>(&result), packed);
+  value = __builtin_bswap64(result);
+  return true;
+}
+
+/**
+ * @brief convert up to 16 decimal digits
+ */
+IB_SIMD_PARSE static bool parse_dec16(const char * const data, const size_t size, uint64_t &value)
+{
+  ///right align digits behind '0' padding
+  char buffer[16];
+  memset(buffer, '0', sizeof(buffer) - size);
+  memcpy(buffer + sizeof(buffer) - size, data, size);
+
+  const __m128i digits = _mm_sub_epi8(
+    _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer)),
+    _mm_set1_epi8('0')
+  );
+
+  if(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits)) != 0xFFFF)
+    return false;
+
+  ///2, 4 then 8 digit groups
+  const __m128i pairs = _mm_maddubs_epi16(digits, _mm_set1_epi16(0x010A));
+  const __m128i quads = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00010064));
+  const __m128i packed = _mm_packs_epi32(quads, quads);
+  const __m128i octets = _mm_madd_epi16(packed, _mm_set1_epi32(0x00012710));
+
+  const uint64_t high = static_cast<uint32_t>(_mm_cvtsi128_si32(octets));
+  const uint64_t low = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(octets, 4)));
+
+  value = high * 100000000ULL + low;
+  return true;
+}
+#endif
+
+bool ib::parse_hex(const char * const data, const size_t size, uint64_t &value)
+{
+  const char *itr = data;
+  const char * const end = data + size;
+
+  if(size >= 2 && itr[0] == '0' && (itr[1] == 'x' || itr[1] == 'X'))
+    itr += 2;
+
+  if(itr == end || end - itr > 16)
+    return false;
+
+#ifdef IB_SIMD_PARSE
+  if(has_ssse3 && end - itr == 16)
+    return parse_hex16(itr, value);
+#endif
+
+  return parse_hex_scalar(itr, end, value);
+}
+
+bool ib::parse_uint(const char * const data, const size_t size, uint64_t &value)
+{
+  if(!size)
+    return false;
+
+#ifdef IB_SIMD_PARSE
+  ///20 digits is the most a uint64_t can hold
+  if(has_ssse3 && size <= 20)
+  {
+    const size_t head = size > 16 ? size - 16 : 0;
+
+    uint64_t high = 0, low = 0;
+    if(!parse_uint_scalar(data, data + head, high) || !parse_dec16(data + head, size - head, low))
+      return false;
+
+    if(!head)
+    {
+      value = low;
+      return true;
+    }
+
+    ///high * 10^16 + low must fit: UINT64_MAX = 1844 6744073709551615
+    static const uint64_t E16 = 10000000000000000ULL;
+    if(high > UINT64_MAX / E16 || (high == UINT64_MAX / E16 && low > UINT64_MAX % E16))
+      return false;
+
+    value = high * E16 + low;
+    return true;
+  }
+#endif
+
+  return parse_uint_scalar(data, data + size, value);
+}
@@ -0,0 +1,58 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <stdint.h>
+#include <cstddef>
+
+#ifndef IB_TULIP_NUMBERS_H
+#define IB_TULIP_NUMBERS_H
+
+namespace infiniband
+{
+
+/**
+ * Field parsers of the CSV importer and the ibdiagnet2.fdbs routes
+ * parser. Topologies are still parsed by libibautils with its own
+ * conversions. numbers_benchmark times both against the regex casts.
+ */
+
+/**
+ * @brief parse hex number with optional 0x prefix
+ *
+ * GUIDs written as exactly 16 hex digits take a SIMD path on CPUs
+ * with SSSE3, anything else is parsed by the scalar loop.
+ *
+ * @return false if empty, more than 16 digits or a non hex digit
+ */
+bool parse_hex(const char * const data, const size_t size, uint64_t &value);
+
+/**
+ * @brief parse unsigned decimal number
+ *
+ * The last 16 digits are converted at once on CPUs with SSSE3.
+ *
+ * @return false if empty, overflows or has a non digit
+ */
+bool parse_uint(const char * const data, const size_t size, uint64_t &value);
+
+}
+
+#endif // IB_TULIP_NUMBERS_H
@@ -0,0 +1,105 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "numbers.h"
+#include "ibautils/regex.h"
+
+/**
+ * Microbenchmark of parse_hex()/parse_uint() against the regex casts
+ * they replaced in the CSV importer.
+ *
+ * usage: numbers_benchmark [fields]
+ */
+
+namespace ib = infiniband;
+
+typedef std::chrono::steady_clock steady_t;
+
+/**
+ * @brief run parse over every field and print nanoseconds per field
+ * @return sum of parsed values so the loop is not optimized away
+ */
+template<class parse_t>
+static uint64_t run(const char * const name, const std::vector<std::string> &fields, parse_t parse)
+{
+  uint64_t sum = 0;
+
+  const steady_t::time_point start = steady_t::now();
+  for(size_t i = 0; i < fields.size(); ++i)
+    sum += parse(fields[i]);
+  const steady_t::time_point end = steady_t::now();
+
+  const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+  printf("%-28s %8.2f ns/field\n", name, fields.empty() ? 0 : ns / fields.size());
+
+  return sum;
+}
+
+int main(int argc, char **argv)
+{
+  const size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 1000000;
+
+  /**
+   * 0x prefixed 16 digit GUIDs and counters of every length below 2^63
+   */
+  std::mt19937_64 random(42);
+  std::vector<std::string> guids, counters;
+  guids.reserve(count);
+  counters.reserve(count);
+
+  char buffer[32];
+  for(size_t i = 0; i < count; ++i)
+  {
+    snprintf(buffer, sizeof(buffer), "0x%016llx", static_cast<unsigned long long>(random()));
+    guids.push_back(buffer);
+
+    snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(random() >> (1 + random() % 63)));
+    counters.push_back(buffer);
+  }
+
+  uint64_t check = 0;
+
+  check ^= run("regex::uint_cast_hex_string", guids, [](const std::string &field) {
+    return regex::uint_cast_hex_string<uint64_t>(field);
+  });
+  check ^= run("ib::parse_hex", guids, [](const std::string &field) {
+    uint64_t value = 0;
+    ib::parse_hex(field.data(), field.size(), value);
+    return value;
+  });
+
+  check ^= run("regex::int_cast_string", counters, [](const std::string &field) {
+    return static_cast<uint64_t>(regex::int_cast_string<int64_t>(field));
+  });
+  check ^= run("ib::parse_uint", counters, [](const std::string &field) {
+    uint64_t value = 0;
+    ib::parse_uint(field.data(), field.size(), value);
+    return value;
+  });
+
+  ///identical results cancel out pairwise
+  printf("checksum %llx\n", static_cast<unsigned long long>(check));
+  return 0;
+}
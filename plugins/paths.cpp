@@ -0,0 +1,362 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include "paths.h"
+
+namespace ib = infiniband;
+
+const ib::shortest_paths_t::distance_t ib::shortest_paths_t::UNREACHABLE;
+
+ib::shortest_paths_t::shortest_paths_t(const ib::adjacency_t &_adjacency)
+  : adjacency(_adjacency), source(ib::adjacency_t::INVALID_INDEX)
+{
+  queue.reserve(adjacency.size());
+}
+
+void ib::shortest_paths_t::reset(const index_t _source)
+{
+  assert(_source < adjacency.size());
+
+  source = _source;
+  distances.assign(adjacency.size(), UNREACHABLE);
+  predecessors.assign(adjacency.size(), ib::adjacency_t::INVALID_INDEX);
+  distances[source] = 0;
+}
+
+void ib::shortest_paths_t::bfs(const index_t _source)
+{
+  reset(_source);
+
+  /**
+   * queue is a flat array: head chases tail
+   */
+  queue.clear();
+  queue.push_back(source);
+
+  for(size_t head = 0; head < queue.size(); ++head)
+  {
+    const index_t u = queue[head];
+    const distance_t next = distances[u] + 1;
+
+    for(const index_t *itr = adjacency.begin(u), *eitr = adjacency.end(u); itr != eitr; ++itr)
+    {
+      if(distances[*itr] == UNREACHABLE)
+      {
+        distances[*itr] = next;
+        predecessors[*itr] = u;
+        queue.push_back(*itr);
+      }
+    }
+  }
+}
+
+void ib::shortest_paths_t::dijkstra(const index_t _source, const std::vector<distance_t> &weights)
+{
+  assert(weights.size() == adjacency.arcs());
+  reset(_source);
+
+  /**
+   * binary heap with lazy deletion of stale entries
+   */
+  typedef std::pair<distance_t, index_t> entry_t;
+  std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t> > heap;
+  heap.push(entry_t(0, source));
+
+  while(!heap.empty())
+  {
+    const entry_t top = heap.top();
+    heap.pop();
+
+    const index_t u = top.second;
+    if(top.first != distances[u])
+      continue;
+
+    const index_t *first = adjacency.begin(u);
+    const size_t offset = adjacency.arc_offset(u);
+    for(const index_t *itr = first, *eitr = adjacency.end(u); itr != eitr; ++itr)
+    {
+      const distance_t weight = weights[offset + (itr - first)];
+      if(weight == UNREACHABLE)
+        continue;
+
+      ///saturate long paths instead of wrapping around
+      const distance_t next = weight < UNREACHABLE - 1 - top.first ? top.first + weight : UNREACHABLE - 1;
+      if(next < distances[*itr])
+      {
+        distances[*itr] = next;
+        predecessors[*itr] = u;
+        heap.push(entry_t(next, *itr));
+      }
+    }
+  }
+}
+
+std::vector<ib::shortest_paths_t::distance_t> ib::shortest_paths_t::arc_weights(
+  const tlp::Graph * const graph,
+  const ib::adjacency_t &adjacency,
+  const tlp::NumericProperty * const property
+)
+{
+  assert(graph);
+  assert(property);
+
+  std::vector<distance_t> weights(adjacency.arcs(), UNREACHABLE);
+
+  const std::vector<tlp::edge> &edges = graph->edges();
+  for(size_t i = 0; i < edges.size(); ++i)
+  {
+    const std::pair<tlp::node, tlp::node> &ends = graph->ends(edges[i]);
+    const index_t s = adjacency.index(ends.first);
+    const index_t t = adjacency.index(ends.second);
+    if(s == t || s == ib::adjacency_t::INVALID_INDEX || t == ib::adjacency_t::INVALID_INDEX)
+      continue;
+
+    /**
+     * round to integer weights, clamped below UNREACHABLE
+     * so heavy arcs are still distinct from missing ones
+     */
+    static const distance_t HEAVIEST = UNREACHABLE - 1;
+    const double value = property->getEdgeDoubleValue(edges[i]);
+    distance_t weight = 0;
+    if(value >= HEAVIEST)
+      weight = HEAVIEST;
+    else if(value > 0)
+      weight = static_cast<distance_t>(value + 0.5);
+
+    /**
+     * rows are sorted: find arc in both directions
+     */
+    const index_t *arc = std::lower_bound(adjacency.begin(s), adjacency.end(s), t);
+    if(arc == adjacency.end(s) || *arc != t)
+      continue; ///graph changed after snapshot was made
+    distance_t &st = weights[adjacency.arc_offset(s) + (arc - adjacency.begin(s))];
+    st = std::min(st, weight);
+
+    arc = std::lower_bound(adjacency.begin(t), adjacency.end(t), s);
+    if(arc == adjacency.end(t) || *arc != s)
+      continue;
+    distance_t &ts = weights[adjacency.arc_offset(t) + (arc - adjacency.begin(t))];
+    ts = std::min(ts, weight);
+  }
+
+  return weights;
+}
+
+std::vector<ib::shortest_paths_t::index_t> ib::shortest_paths_t::trace(const index_t target) const
+{
+  std::vector<index_t> path;
+  if(target >= distances.size() || distances[target] == UNREACHABLE)
+    return path;
+
+  for(index_t pos = target; pos != ib::adjacency_t::INVALID_INDEX; pos = predecessors[pos])
+    path.push_back(pos);
+
+  assert(path.back() == source);
+  return path;
+}
+
+ib::hop_matrix_t::hop_matrix_t(const index_t _rows, const index_t _columns, const unsigned int _bits)
+  : row_count(_rows), column_count(_columns), bit_count(_bits == 4 ? 4 : 8),
+    stride(bit_count == 4 ? (static_cast<size_t>(_columns) + 1) / 2 : _columns),
+    data(stride * _rows, 0xFF)
+{
+}
+
+namespace
+{
+  /**
+   * @brief one bit per source lane of a batch
+   * @note fixed size loops so the compiler can use vector registers
+   */
+#ifdef __AVX2__
+  static const size_t WORDS = 4;
+#else
+  static const size_t WORDS = 1;
+#endif
+  static const size_t LANES = WORDS * 64;
+
+  struct lanes_t
+  {
+    uint64_t word[WORDS];
+
+    void clear() { for(size_t i = 0; i < WORDS; ++i) word[i] = 0; }
+
+    bool any() const
+    {
+      uint64_t value = 0;
+      for(size_t i = 0; i < WORDS; ++i) value |= word[i];
+      return value != 0;
+    }
+  };
+
+  /**
+   * @brief state of one thread: bitsets per node
+   */
+  struct batch_t
+  {
+    std::vector<lanes_t> seen;
+    std::vector<lanes_t> visit;
+    std::vector<lanes_t> next;
+
+    /**
+     * @brief target column of every node or INVALID_INDEX
+     */
+    const std::vector<ib::adjacency_t::index_t> &columns;
+
+    batch_t(const ib::adjacency_t::index_t size, const std::vector<ib::adjacency_t::index_t> &_columns)
+      : seen(size), visit(size), next(size), columns(_columns)
+    {
+    }
+
+    /**
+     * @brief run BFS from sources [first, last) as one batch
+     */
+    void run(
+      const ib::adjacency_t &adjacency,
+      const std::vector<ib::adjacency_t::index_t> &sources,
+      const size_t first,
+      const size_t last,
+      ib::hop_matrix_t &matrix
+    )
+    {
+      const ib::adjacency_t::index_t size = adjacency.size();
+      for(ib::adjacency_t::index_t v = 0; v < size; ++v)
+      {
+        seen[v].clear();
+        visit[v].clear();
+        next[v].clear();
+      }
+
+      for(size_t i = first; i < last; ++i)
+      {
+        const size_t lane = i - first;
+        const ib::adjacency_t::index_t source = sources[i];
+        seen[source].word[lane / 64] |= uint64_t(1) << (lane % 64);
+        visit[source].word[lane / 64] |= uint64_t(1) << (lane % 64);
+
+        if(columns[source] != ib::adjacency_t::INVALID_INDEX)
+          matrix.set(static_cast<ib::adjacency_t::index_t>(i), columns[source], 0);
+      }
+
+      for(uint32_t level = 1; ; ++level)
+      {
+        bool active = false;
+
+        for(ib::adjacency_t::index_t v = 0; v < size; ++v)
+        {
+          if(!visit[v].any())
+            continue;
+
+          for(const ib::adjacency_t::index_t *itr = adjacency.begin(v), *eitr = adjacency.end(v); itr != eitr; ++itr)
+          {
+            lanes_t &n_seen = seen[*itr];
+            lanes_t &n_next = next[*itr];
+            for(size_t w = 0; w < WORDS; ++w)
+            {
+              const uint64_t reached = visit[v].word[w] & ~n_seen.word[w];
+              n_next.word[w] |= reached;
+              n_seen.word[w] |= reached;
+            }
+          }
+        }
+
+        /**
+         * record hop count for every newly reached (source, target)
+         */
+        for(ib::adjacency_t::index_t v = 0; v < size; ++v)
+        {
+          visit[v] = next[v];
+          next[v].clear();
+
+          if(!visit[v].any())
+            continue;
+
+          active = true;
+          if(columns[v] == ib::adjacency_t::INVALID_INDEX)
+            continue;
+
+          for(size_t w = 0; w < WORDS; ++w)
+          {
+            for(uint64_t bits = visit[v].word[w]; bits; bits &= bits - 1)
+            {
+              const size_t lane = w * 64 + __builtin_ctzll(bits);
+              matrix.set(static_cast<ib::adjacency_t::index_t>(first + lane), columns[v], level);
+            }
+          }
+        }
+
+        if(!active)
+          break;
+      }
+    }
+  };
+}
+
+void ib::all_pairs_hops(
+  const ib::adjacency_t &adjacency,
+  const std::vector<ib::adjacency_t::index_t> &sources,
+  const std::vector<ib::adjacency_t::index_t> &targets,
+  ib::hop_matrix_t &matrix,
+  unsigned int threads
+)
+{
+  assert(matrix.rows() == sources.size());
+  assert(matrix.columns() == targets.size());
+
+  /**
+   * map every node to its target column
+   */
+  std::vector<ib::adjacency_t::index_t> columns(adjacency.size(), ib::adjacency_t::INVALID_INDEX);
+  for(size_t i = 0; i < targets.size(); ++i)
+    columns[targets[i]] = static_cast<ib::adjacency_t::index_t>(i);
+
+  const size_t batches = (sources.size() + LANES - 1) / LANES;
+  if(!threads)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned int>(std::min<size_t>(threads, batches));
+
+  /**
+   * every thread grabs the next batch until none are left
+   * rows of a batch are only written by the thread running it
+   */
+  std::atomic<size_t> next_batch(0);
+  std::vector<std::thread> pool;
+
+  for(unsigned int t = 0; t < threads; ++t)
+  {
+    pool.push_back(std::thread([&]()
+    {
+      batch_t batch(adjacency.size(), columns);
+
+      for(size_t b = next_batch++; b < batches; b = next_batch++)
+      {
+        const size_t first = b * LANES;
+        batch.run(adjacency, sources, first, std::min(first + LANES, sources.size()), matrix);
+      }
+    }));
+  }
+
+  for(size_t t = 0; t < pool.size(); ++t)
+    pool[t].join();
+}
@@ -0,0 +1,211 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <tulip/TulipPluginHeaders.h>
+#include "adjacency.h"
+
+#ifndef IB_TULIP_PATHS_H
+#define IB_TULIP_PATHS_H
+
+namespace infiniband
+{
+
+/**
+ * @brief Single source shortest paths over an adjacency snapshot
+ *
+ * Every edge of the fabric has a weight of 1, so the default engine is
+ * a plain BFS over flat arrays which is O(V+E). A binary heap Dijkstra
+ * is provided for weighted modes (weights per arc of the snapshot).
+ *
+ * All indexes are the dense indexes of adjacency_t.
+ */
+class shortest_paths_t
+{
+public:
+  typedef adjacency_t::index_t index_t;
+  typedef uint32_t distance_t;
+
+  /**
+   * @brief distance of nodes that can not be reached from source
+   */
+  static const distance_t UNREACHABLE = ~static_cast<distance_t>(0);
+
+  shortest_paths_t(const adjacency_t &_adjacency);
+
+  /**
+   * @brief run unweighted shortest paths (BFS) from source
+   * @param source dense index of source node
+   */
+  void bfs(const index_t source);
+
+  /**
+   * @brief run weighted shortest paths (Dijkstra) from source
+   * @param source dense index of source node
+   * @param weights weight per arc (see arc_weights()), distances saturate at UNREACHABLE - 1
+   */
+  void dijkstra(const index_t source, const std::vector<distance_t> &weights);
+
+  /**
+   * @brief build weight per arc of snapshot from a numeric property
+   * @note parallel edges use the smallest weight
+   * @param graph graph the snapshot was built from
+   * @param adjacency snapshot of graph
+   * @param property edge weights (rounded and clamped to [0, UNREACHABLE - 1])
+   */
+  static std::vector<distance_t> arc_weights(
+    const tlp::Graph * const graph,
+    const adjacency_t &adjacency,
+    const tlp::NumericProperty * const property
+  );
+
+  /**
+   * @brief source of last run
+   */
+  index_t get_source() const { return source; }
+
+  /**
+   * @brief distance from source or UNREACHABLE
+   */
+  distance_t distance(const index_t index) const { return distances[index]; }
+
+  /**
+   * @brief previous node on path from source or INVALID_INDEX
+   */
+  index_t predecessor(const index_t index) const { return predecessors[index]; }
+
+  /**
+   * @brief distance of every node from source
+   */
+  const std::vector<distance_t> &get_distances() const { return distances; }
+
+  /**
+   * @brief nodes on path from target back to source (inclusive)
+   * @return path or empty if target is unreachable
+   */
+  std::vector<index_t> trace(const index_t target) const;
+
+private:
+  /**
+   * @brief reset state for a new source
+   */
+  void reset(const index_t _source);
+
+  const adjacency_t &adjacency;
+  index_t source;
+  std::vector<distance_t> distances;
+  std::vector<index_t> predecessors;
+  std::vector<index_t> queue;
+};
+
+/**
+ * @brief Compact hop count matrix (sources x targets)
+ *
+ * Every entry uses either 4 or 8 bits. The largest value of an entry
+ * (15 or 255) marks an unreachable (or too distant) target. Rows are
+ * byte aligned so different rows may be written by different threads.
+ */
+class hop_matrix_t
+{
+public:
+  typedef adjacency_t::index_t index_t;
+
+  hop_matrix_t(const index_t _rows, const index_t _columns, const unsigned int _bits);
+
+  index_t rows() const { return row_count; }
+  index_t columns() const { return column_count; }
+  unsigned int bits() const { return bit_count; }
+
+  /**
+   * @brief value marking unreachable targets
+   */
+  uint8_t unreachable() const { return bit_count == 4 ? 0xF : 0xFF; }
+
+  /**
+   * @brief get hops between source row and target column
+   */
+  uint8_t get(const index_t row, const index_t column) const
+  {
+    assert(row < row_count && column < column_count);
+    if(bit_count == 8)
+      return data[row * stride + column];
+
+    const uint8_t byte = data[row * stride + column / 2];
+    return column & 1 ? byte >> 4 : byte & 0xF;
+  }
+
+  /**
+   * @brief set hops between source row and target column (saturating)
+   */
+  void set(const index_t row, const index_t column, const uint32_t hops)
+  {
+    assert(row < row_count && column < column_count);
+    const uint8_t value = hops < unreachable() ? static_cast<uint8_t>(hops) : unreachable();
+    if(bit_count == 8)
+    {
+      data[row * stride + column] = value;
+      return;
+    }
+
+    uint8_t &byte = data[row * stride + column / 2];
+    byte = column & 1 ? (byte & 0x0F) | (value << 4) : (byte & 0xF0) | value;
+  }
+
+  /**
+   * @brief raw row storage (for dumping to file)
+   */
+  const uint8_t *row(const index_t row) const { return &data[row * stride]; }
+  size_t row_bytes() const { return stride; }
+
+private:
+  index_t row_count;
+  index_t column_count;
+  unsigned int bit_count;
+  size_t stride;
+  std::vector<uint8_t> data;
+};
+
+/**
+ * @brief Bit-parallel multi source BFS for all pairs hop counts
+ *
+ * Runs LANES sources at once: every node carries a bitset of the sources
+ * that have reached it, so one sweep over the adjacency snapshot advances
+ * all LANES searches by one hop. Batches of sources are spread over
+ * threads. LANES is 256 when built with AVX2 and 64 otherwise.
+ *
+ * @param adjacency snapshot to walk
+ * @param sources dense indexes of sources (one matrix row each)
+ * @param targets dense indexes of targets (one matrix column each)
+ * @param matrix output matrix (sources.size() x targets.size())
+ * @param threads number of threads (0 for hardware concurrency)
+ */
+void all_pairs_hops(
+  const adjacency_t &adjacency,
+  const std::vector<adjacency_t::index_t> &sources,
+  const std::vector<adjacency_t::index_t> &targets,
+  hop_matrix_t &matrix,
+  unsigned int threads
+);
+
+}
+
+#endif // IB_TULIP_PATHS_H
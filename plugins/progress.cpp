@@ -0,0 +1,108 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include "progress.h"
+
+namespace ib = infiniband;
+
+/**
+ * @brief least time between progress updates
+ */
+static const std::chrono::milliseconds REPORT_INTERVAL(100);
+
+/**
+ * @brief byte progress is reported in steps of 1/STEPS
+ */
+static const int STEPS = 1000;
+
+ib::import_progress_t::import_progress_t(tlp::PluginProgress * const _progress)
+  : progress(_progress), state(tlp::TLP_CONTINUE)
+{
+}
+
+bool ib::import_progress_t::stage(const std::string &_name)
+{
+  finish();
+
+  name = _name;
+  started = steady_t::now();
+  reported = started;
+
+  if(progress)
+  {
+    progress->setComment(name);
+    if(state == tlp::TLP_CONTINUE)
+      state = progress->progress(0, STEPS);
+  }
+
+  return !cancelled();
+}
+
+bool ib::import_progress_t::bytes(const size_t done, const size_t total)
+{
+  if(!progress || cancelled())
+    return !cancelled();
+
+  const steady_t::time_point now = steady_t::now();
+  if(now - reported < REPORT_INTERVAL)
+    return true;
+  reported = now;
+
+  std::stringstream comment;
+  comment << name << ": " << std::fixed << std::setprecision(1) <<
+    done / 1048576.0 << " of " << total / 1048576.0 << " MiB";
+
+  const double seconds = std::chrono::duration<double>(now - started).count();
+  if(done && done < total && seconds > 1)
+    comment << ", " << static_cast<long>(seconds * (total - done) / done) << "s left";
+
+  progress->setComment(comment.str());
+  state = progress->progress(total ? static_cast<int>(static_cast<double>(done) / total * STEPS) : 0, STEPS);
+
+  return !cancelled();
+}
+
+ib::progress_t ib::import_progress_t::callback()
+{
+  return std::bind(&import_progress_t::bytes, this, std::placeholders::_1, std::placeholders::_2);
+}
+
+std::string ib::import_progress_t::finish()
+{
+  if(!name.empty())
+  {
+    timings.push_back(std::make_pair(name, std::chrono::duration<double>(steady_t::now() - started).count()));
+
+#ifndef NDEBUG
+    std::cerr << name << ": " << timings.back().second << "s" << std::endl;
+#endif
+
+    name.clear();
+  }
+
+  std::stringstream result;
+  result << std::fixed << std::setprecision(2);
+  for(size_t i = 0; i < timings.size(); ++i)
+    result << (i ? ", " : "") << timings[i].first << ": " << timings[i].second << "s";
+
+  return result.str();
+}
@@ -0,0 +1,98 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <tulip/PluginProgress.h>
+#include "input_stream.h"
+
+#ifndef IB_TULIP_PROGRESS_H
+#define IB_TULIP_PROGRESS_H
+
+namespace infiniband
+{
+
+/**
+ * @brief Stage timings and byte progress of an import
+ *
+ * Wraps the plugin progress (which may be NULL): every stage sets the
+ * comment and is timed, parsers report bytes through callback() and
+ * learn about Cancel or Stop from its return value.
+ */
+class import_progress_t
+{
+public:
+  import_progress_t(tlp::PluginProgress * const _progress);
+
+  /**
+   * @brief end current stage and start next one
+   * @param name stage name shown as comment
+   * @return false if import was cancelled or stopped
+   */
+  bool stage(const std::string &name);
+
+  /**
+   * @brief report bytes of current stage
+   * @note the comment, bar and Cancel/Stop state are only refreshed every
+   *   100 ms, calls in between return the state of the last refresh
+   * @return false if import was cancelled or stopped
+   */
+  bool bytes(const size_t done, const size_t total);
+
+  /**
+   * @brief bytes() as parser callback
+   */
+  progress_t callback();
+
+  /**
+   * @brief true if user pressed Cancel or Stop
+   */
+  bool cancelled() const { return state != tlp::TLP_CONTINUE; }
+
+  /**
+   * @brief TLP_CANCEL (undo) or TLP_STOP (keep results)
+   * @note importers fail on Cancel and finish with what was read on Stop
+   */
+  tlp::ProgressState get_state() const { return state; }
+
+  /**
+   * @brief end current stage
+   * @return every stage with its duration, e.g. "Parsing: 1.25s, Populating: 0.40s"
+   */
+  std::string finish();
+
+private:
+  typedef std::chrono::steady_clock steady_t;
+
+  tlp::PluginProgress * const progress;
+  tlp::ProgressState state;
+
+  std::string name;
+  steady_t::time_point started;
+  steady_t::time_point reported;
+
+  std::vector<std::pair<std::string, double> > timings;
+};
+
+}
+
+#endif // IB_TULIP_PROGRESS_H
@@ -24,6 +24,7 @@
 #include <string>
 #include <set>
 #include "realRoutes.h"
+#include "forwarding.h"
 
 #include <tulip/GlScene.h>
 #include <tulip/BooleanProperty.h>
@@ -46,7 +47,7 @@ static const char * paramHelp[] = {
   HTML_HELP_OPEN() \
   HTML_HELP_DEF( "type", "pathname" ) \
   HTML_HELP_BODY() \
-  "Path to ibdiagnet2.fdbs file to import" \
+  "Path to ibdiagnet2.fdbs file to import (plain, gzip or zstd)" \
   HTML_HELP_CLOSE()
 };
 
@@ -61,142 +62,9 @@ namespace ib = infiniband;
 namespace ibp = infiniband::parser;
 
 const ib::entity_t * RouteAnalysis_All::getMyEntity(const tlp::node node,ib::tulip_fabric_t * const fabric){
-    for(ib::tulip_fabric_t::entity_nodes_t::iterator it1 = fabric->entity_nodes.begin(); it1 != fabric->entity_nodes.end(); ++it1)
-        if(it1->second.id == node.id)
-            return it1->first;
-
-    return nullptr;
-}
-
-int RouteAnalysis_All::help_count(ib::tulip_fabric_t * const fabric, tlp::Graph * const graph,
-                        std::vector<ib::entity_t *> &tmp, const ib::entity_t * real_target)
-{
-    int count = 0;
-    bool find_next = false;
-    ib::lid_t target_lid = real_target->lid();
-  
-    while(tmp.back()->guid!= real_target->guid) {
-        const ib::entity_t & temp = *tmp.back();
-      
-        for (
-                ib::entity_t::routes_t::const_iterator
-                        ritr = temp.get_routes().begin(),
-                        reitr = temp.get_routes().end();
-                ritr != reitr;
-                ++ritr
-                ) {
-            std::set<ib::lid_t>::const_iterator itr = ritr->second.find(target_lid);
-            if (itr != ritr->second.end()) {
-                const ib::entity_t::portmap_t::const_iterator port_itr = temp.ports.find(ritr->first);
-                if (port_itr != temp.ports.end()) {
-                    const ib::port_t *const port = port_itr->second;
-                    const ib::tulip_fabric_t::port_edges_t::const_iterator edge_itr = fabric->port_edges.find(
-                            const_cast<ib::port_t *>(port));
-                    if (edge_itr != fabric->port_edges.end()) {
-                        const tlp::edge &edge = edge_itr->second;
-                        const ib::entity_t * entity = getMyEntity(graph->target(edge),fabric);
-                        tmp.push_back(const_cast<ib::entity_t *> (entity));
-                        count++;
-                        find_next = true;
-                    }
-                }
-            }
-        }
-      
-        if(!find_next)
-        return -1;
-    }
-
-
-    return count;
-}
-
-
-int RouteAnalysis_All::count_hops(const tlp::node source_node, const tlp::node target_node,tlp::Graph * const graph){
-    //Get the fabric from the graph
-    ib::tulip_fabric_t * const fabric = ib::tulip_fabric_t::find_fabric(graph, false);
-
-    //Set the tulip Properties
-    IntegerProperty *getPortNum = graph->getLocalProperty<IntegerProperty>("ibPortNum");
-
-    //Get the entities' map <guid, entity_t> = entities_t
-    //const ib::fabric_t::entities_t &entities_map = fabric->get_entities();
-
-    const ib::entity_t * source_entity = getMyEntity(source_node,fabric);
-    const ib::entity_t * target_entity = getMyEntity(target_node,fabric);
-    
-    cout<<"Test source_entity guid: "<<source_entity->guid<<endl;
-    cout<<"Test target_entity guid: "<<target_entity->guid<<endl;
-    cout<<"----------Test the source & target entities end------------"<<endl;
-    
-    //ib::lid_t target_lid = target_entity->lid();
-    std::vector<ib::entity_t *> tmp;
-
-    int count = 0;
-    if(getPortNum->getNodeValue(source_node)==1){
-        //find the only port in HCA
-        const ib::entity_t::portmap_t::const_iterator Myport = source_entity->ports.begin();
-
-        //use the typedef std::map<port_t*, tlp::edge> port_edges_t to find the edge
-        ib::tulip_fabric_t::port_edges_t::iterator Myedge = fabric->port_edges.find(Myport->second);
-        if(graph->source(Myedge->second).id == source_node.id){
-            const tlp::edge &e = Myedge->second;
-            tmp.push_back(const_cast<ib::entity_t *> (getMyEntity(graph->target(e),fabric)));
-        }else{
-            const tlp::edge &e = Myedge->second;
-            tmp.push_back(const_cast<ib::entity_t *> (getMyEntity(graph->source(e),fabric)));
-        }
-        count++;
-    }else{
-        tmp.push_back(const_cast<ib::entity_t *> (source_entity));
-    }
-
-    //Whether the target is HCE or not
-    if(getPortNum->getNodeValue(target_node)== 1){
-        //find the only port in HCA
-        const ib::entity_t::portmap_t::const_iterator Myport = target_entity->ports.begin();
-
-        //use the typedef std::map<port_t*, tlp::edge> port_edges_t to find the edge
-        ib::tulip_fabric_t::port_edges_t::iterator Myedge = fabric->port_edges.find(Myport->second);
-        if(graph->source(Myedge->second).id == source_node.id){
-            const tlp::edge &e = Myedge->second;
-            const ib::entity_t * real_target = getMyEntity(graph->target(e),fabric);
-                    
-            int count_temp = help_count(fabric, graph, tmp, real_target);
-            if(count_temp == -1)
-              return -1;
-            else
-              count += count_temp;
-
-
-        }else {
-            //find the only port in HCA
-            const ib::entity_t::portmap_t::const_iterator Myport = target_entity->ports.begin();
-
-            //use the typedef std::map<port_t*, tlp::edge> port_edges_t to find the edge
-            ib::tulip_fabric_t::port_edges_t::iterator Myedge = fabric->port_edges.find(Myport->second);
-            const tlp::edge &e = Myedge->second;
-            const ib::entity_t * real_target = getMyEntity(graph->source(e),fabric);
-            int count_temp = help_count(fabric, graph, tmp, real_target);
-            if(count_temp == -1)
-              return -1;
-            else
-              count += count_temp;
-        }
-            count++;
-    }
-    else{
-        int count_temp = help_count(fabric, graph, tmp, target_entity);
-        if(count_temp == -1)
-          return -1;
-        else
-          count += count_temp;
-
-    }
-    return count;
+    return fabric->get_node_entity(node);
 }
 
-
 bool RouteAnalysis_All::run(){
     assert(graph);
 
@@ -235,14 +103,6 @@ bool RouteAnalysis_All::run(){
     std::string filename;
 
     dataSet->get("file::filename", filename);
-    std::ifstream ifs(filename.c_str());
-    if(!ifs)
-    {
-        if(pluginProgress)
-            pluginProgress->setError("Unable open source file.");
-
-        return false;
-    }
 
     if(pluginProgress)
     {
@@ -250,11 +110,10 @@ bool RouteAnalysis_All::run(){
         pluginProgress->setComment("Parsing Routes.");
     }
 
-    ibp::ibdiagnet_fwd_db parser;
-    if(!parser.parse(*fabric, ifs))
+    if(!fabric->load_routes(filename))
     {
         if(pluginProgress)
-            pluginProgress->setError("Unable parse routes file.");
+            pluginProgress->setError("Unable open or parse routes file.");
 
         return false;
     }
@@ -265,9 +124,6 @@ bool RouteAnalysis_All::run(){
         pluginProgress->progress(3, STEPS);
     }
 
-    ifs.close();
-
-
     if (pluginProgress) {
         pluginProgress->setComment("Found path source and target");
         pluginProgress->progress(4, STEPS);
@@ -277,29 +133,41 @@ bool RouteAnalysis_All::run(){
     tlp::IntegerProperty * ibRealHop = graph->getProperty<tlp::IntegerProperty>("ibRealHop");
     assert(ibRealHop);
 
-    //const ib::fabric_t::entities_t &entities_map = fabric->get_entities();
-    tlp::Iterator<tlp::node> *other = graph->getNodes();
-
     tlp::Iterator<tlp::node> *selections = selectSource->getNodesEqualTo(true,NULL);
+    if(!selections->hasNext())
+    {
+        delete selections;
+        if(pluginProgress)
+            pluginProgress->setError("No source node is selected");
+
+        return false;
+    }
     const tlp::node mySource = selections->next();
+    delete selections;
 
+#ifndef NDEBUG
     cout<<"My Source ID: "<<mySource.id<<endl;
     cout<<"-------------------mySource test end-----------------------"<<endl;
+#endif
 
-    const ib::entity_t * source_entity= getMyEntity(mySource,fabric);
-    while(other->hasNext()){
-        const tlp::node &node = other->next();
-        if(node.id == mySource.id){
-            ibRealHop->setNodeValue(node, 0);
-            continue;
-        }
-        else
-        {
-            const int &temp = count_hops(mySource,node,graph);
-            ibRealHop->setNodeValue(node, temp);
-        }
+    //Walk the LFTs from the source to every destination at once
+    const ib::forwarding_t &forwarding = fabric->get_forwarding();
+    const ib::forwarding_t::index_t source = forwarding.index(mySource);
+    if(source == ib::forwarding_t::INVALID_INDEX)
+    {
+        if(pluginProgress)
+            pluginProgress->setError("Selected source node is not part of the fabric");
+
+        return false;
     }
 
+    std::vector<int> hops;
+    forwarding.hops_from(source, hops, 0);
+
+    //Nodes that are not part of the fabric have no route
+    ibRealHop->setAllNodeValue(ib::forwarding_t::NO_ROUTE);
+    for(ib::forwarding_t::index_t i = 0; i < forwarding.size(); ++i)
+        ibRealHop->setNodeValue(forwarding.node(i), hops[i]);
 
     if(pluginProgress)
     {
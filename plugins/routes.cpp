@@ -19,8 +19,10 @@
  */
 
 #include<fstream>
+#include <vector>
 #include "routes.h"
 #include "fabric.h"
+#include "progress.h"
 #include "ibautils/ib_fabric.h"
 #include "ibautils/ib_parser.h"
 #include "ibautils/regex.h"
@@ -32,7 +34,7 @@ static const char * paramHelp[] = {
   HTML_HELP_OPEN() \
   HTML_HELP_DEF( "type", "pathname" ) \
   HTML_HELP_BODY() \
-  "Path to ibdiagnet2.fdbs file to import" \
+  "Path to ibdiagnet2.fdbs file to import (plain, gzip or zstd)" \
   HTML_HELP_CLOSE()
 };
 
@@ -84,37 +86,24 @@ bool ImportInfinibandRoutes::run()
   std::string filename;
   
   dataSet->get("file::filename", filename);
-  std::ifstream ifs(filename.c_str());
-  if(!ifs)
-  {
-    if(pluginProgress)
-      pluginProgress->setError("Unable open source file.");
 
-    return false;
-  }
+  ///reports bytes parsed between steps 2 and 3
+  ib::import_progress_t progress(pluginProgress);
+  progress.stage("Parsing Routes.");
 
-  if(pluginProgress)
-  {
-    pluginProgress->progress(2, STEPS);
-    pluginProgress->setComment("Parsing Routes.");
-  }
-  
-  ibp::ibdiagnet_fwd_db parser;
-  if(!parser.parse(*fabric, ifs))
+  if(!fabric->load_routes(filename, progress.callback()))
   {
     if(pluginProgress)
-      pluginProgress->setError("Unable parse routes file.");
+      pluginProgress->setError(progress.cancelled() ? "Import cancelled." : "Unable open or parse routes file.");
 
     return false;
   }
 
   if(pluginProgress)
   {
-    pluginProgress->setComment("Parsing Routes complete.");
+    pluginProgress->setComment("Parsing Routes complete (" + progress.finish() + ").");
     pluginProgress->progress(3, STEPS);
   }
-
-  ifs.close();
       
   /**
    * calculate routes outbound
@@ -139,27 +128,31 @@ bool ImportInfinibandRoutes::run()
   {
     const ib::entity_t &entity = itr->second;
 
+    const ib::lft_t::row_t * const row = fabric->lft.find(entity.guid);
+    if(!row)
+      continue;
+
+    /**
+     * count LIDs routed out of every port
+     */
+    std::vector<size_t> routes(static_cast<ib::port_num_t>(~0) + 1, 0);
+    for(size_t lid = 0; lid < row->size(); ++lid)
+      ++routes[(*row)[lid]];
+
     for(
-      ib::entity_t::routes_t::const_iterator
-      ritr =  entity.get_routes().begin(),
-      reitr = entity.get_routes().end();
-      ritr != reitr;
-      ++ritr
+      ib::entity_t::portmap_t::const_iterator
+      pitr = entity.ports.begin(),
+      peitr = entity.ports.end();
+      pitr != peitr;
+      ++pitr
     )
     {
-      const ib::entity_t::routes_t::mapped_type set = ritr->second;
-      const ib::entity_t::portmap_t::const_iterator port_itr = entity.ports.find(ritr->first);
-      if(port_itr != entity.ports.end())
-      {
-        const ib::port_t* const port = port_itr->second;
-        const ib::tulip_fabric_t::port_edges_t::const_iterator edge_itr = fabric->port_edges.find(const_cast<ib::port_t*>(port));
-        if(edge_itr != fabric->port_edges.end())
-        {
-          const tlp::edge &edge = edge_itr->second;
-        
-          ibRoutesOutbound->setEdgeValue(edge, ritr->second.size());
-        }
-      }
+      if(!pitr->first || !routes[pitr->first])
+        continue;
+
+      const ib::tulip_fabric_t::port_slot_t * const slot = fabric->find_port_edge(pitr->second->guid, pitr->first);
+      if(slot)
+        ibRoutesOutbound->setEdgeValue(slot->edge, routes[pitr->first]);
     }
   }
 
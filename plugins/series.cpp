@@ -0,0 +1,165 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "series.h"
+
+namespace ib = infiniband;
+
+ib::metric_series_t::metric_series_t()
+  : capacity(0), edges(0), head(0), count(0), replaced_time(0), replaced_head(0), replaced_count(0)
+{
+}
+
+void ib::metric_series_t::reset(const size_t _capacity, const size_t _edges)
+{
+  capacity = _capacity;
+  edges = _edges;
+  head = 0;
+  count = 0;
+
+  values.assign(capacity * edges, std::numeric_limits<double>::quiet_NaN());
+  times.assign(capacity, 0);
+}
+
+void ib::metric_series_t::grow(const size_t _edges)
+{
+  if(_edges <= edges)
+    return;
+
+  ///columns are per edge: new edges are appended
+  edges = _edges;
+  values.resize(capacity * edges, std::numeric_limits<double>::quiet_NaN());
+}
+
+void ib::metric_series_t::push()
+{
+  if(!capacity)
+    return;
+
+  replaced_head = head;
+  replaced_count = count;
+
+  head = count ? (head + 1) % capacity : 0;
+  if(count < capacity)
+    ++count;
+
+  ///keep the oldest snapshot until the new one is kept
+  replaced.resize(edges);
+  replaced_time = times[head];
+
+  times[head] = 0;
+  for(size_t i = 0; i < edges; ++i)
+  {
+    replaced[i] = values[i * capacity + head];
+    values[i * capacity + head] = std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+void ib::metric_series_t::undo_push()
+{
+  if(!count)
+    return;
+
+  times[head] = replaced_time;
+  for(size_t i = 0; i < edges; ++i)
+    values[i * capacity + head] = i < replaced.size() ? replaced[i] : std::numeric_limits<double>::quiet_NaN();
+
+  head = replaced_head;
+  count = replaced_count;
+  replaced.clear();
+}
+
+void ib::metric_series_t::set(const tlp::edge &edge, const double value)
+{
+  if(!count || edge.id >= edges)
+    return;
+
+  values[edge.id * capacity + head] = value;
+}
+
+void ib::metric_series_t::set_time(const uint64_t time)
+{
+  if(count)
+    times[head] = time;
+}
+
+void ib::metric_series_t::forget(const tlp::edge &edge)
+{
+  if(edge.id >= edges)
+    return;
+
+  std::fill(
+    values.begin() + edge.id * capacity,
+    values.begin() + (edge.id + 1) * capacity,
+    std::numeric_limits<double>::quiet_NaN()
+  );
+}
+
+bool ib::metric_series_t::aggregate(const tlp::edge &edge, aggregate_t &result) const
+{
+  if(!count || edge.id >= edges)
+    return false;
+
+  /**
+   * column of the edge holds every retained slot,
+   * order does not matter for the aggregates
+   */
+  std::vector<double> samples;
+  samples.reserve(count);
+
+  const double * const column = &values[edge.id * capacity];
+  for(size_t slot = 0; slot < capacity; ++slot)
+    if(!std::isnan(column[slot]))
+      samples.push_back(column[slot]);
+
+  if(samples.empty())
+    return false;
+
+  result.samples = samples.size();
+  result.min = result.max = samples[0];
+
+  double sum = 0;
+  for(size_t i = 0; i < samples.size(); ++i)
+  {
+    result.min = std::min(result.min, samples[i]);
+    result.max = std::max(result.max, samples[i]);
+    sum += samples[i];
+  }
+  result.mean = sum / samples.size();
+
+  ///nearest rank
+  const size_t rank = static_cast<size_t>(std::ceil(0.95 * samples.size())) - 1;
+  std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+  result.p95 = samples[rank];
+
+  return true;
+}
+
+bool ib::metric_series_t::time_range(uint64_t &first, uint64_t &last) const
+{
+  if(!count)
+    return false;
+
+  first = times[(head + capacity + 1 - count) % capacity];
+  last = times[head];
+  return true;
+}
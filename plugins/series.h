@@ -0,0 +1,152 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include <tulip/Edge.h>
+
+#ifndef IB_TULIP_SERIES_H
+#define IB_TULIP_SERIES_H
+
+namespace infiniband
+{
+
+/**
+ * @brief Fixed capacity time series of a metric on every edge
+ *
+ * Keeps the last capacity snapshots of an imported metric. Storage
+ * is preallocated as one column of samples per edge (indexed by
+ * edge.id) so memory is bounded by capacity * edges, and the oldest
+ * snapshot is overwritten by each new one.
+ */
+class metric_series_t
+{
+public:
+  metric_series_t();
+
+  /**
+   * @brief window aggregates of one edge
+   */
+  struct aggregate_t
+  {
+    double min;
+    double max;
+    double mean;
+    double p95;
+    size_t samples;
+  };
+
+  /**
+   * @brief drop every sample and preallocate storage
+   * @param capacity snapshots retained per edge
+   * @param edges edges tracked, edge.id must be less than this
+   */
+  void reset(const size_t capacity, const size_t edges);
+
+  /**
+   * @brief track more edges, keeping every retained sample
+   * @param edges edges tracked, never less than before
+   * @note samples of new edges are missing
+   */
+  void grow(const size_t edges);
+
+  /**
+   * @brief start new snapshot, replacing oldest one if full
+   * @note every edge is missing from snapshot until set()
+   */
+  void push();
+
+  /**
+   * @brief drop newest snapshot, restoring the one the last push() replaced
+   * @note only undoes a single push(), such as of a cancelled import
+   */
+  void undo_push();
+
+  /**
+   * @brief set value of edge in newest snapshot
+   * @note edges outside preallocated range are ignored
+   */
+  void set(const tlp::edge &edge, const double value);
+
+  /**
+   * @brief set time of newest snapshot
+   * @param time nanoseconds since epoch
+   */
+  void set_time(const uint64_t time);
+
+  /**
+   * @brief drop every sample of a deleted edge (Tulip reuses edge ids)
+   */
+  void forget(const tlp::edge &edge);
+
+  /**
+   * @brief min, max, mean and 95th percentile over retained samples of edge
+   * @return false if edge has no samples
+   */
+  bool aggregate(const tlp::edge &edge, aggregate_t &result) const;
+
+  /**
+   * @brief time of oldest and newest retained snapshot
+   * @return false if there are no snapshots
+   */
+  bool time_range(uint64_t &first, uint64_t &last) const;
+
+  size_t get_capacity() const { return capacity; }
+  size_t get_edges() const { return edges; }
+
+  /**
+   * @brief number of retained snapshots
+   */
+  size_t size() const { return count; }
+
+private:
+  size_t capacity;
+  size_t edges;
+
+  /**
+   * @brief slot of newest snapshot and number of snapshots
+   */
+  size_t head;
+  size_t count;
+
+  /**
+   * @brief values[edge.id * capacity + slot], NaN if missing
+   */
+  std::vector<double> values;
+
+  /**
+   * @brief time of every slot
+   */
+  std::vector<uint64_t> times;
+
+  /**
+   * @brief slot overwritten by the last push() and state before it
+   */
+  std::vector<double> replaced;
+  uint64_t replaced_time;
+  size_t replaced_head;
+  size_t replaced_count;
+};
+
+}
+
+#endif // IB_TULIP_SERIES_H
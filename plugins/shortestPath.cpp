@@ -30,6 +30,7 @@
 #include <tulip/ColorProperty.h>
 
 #include "shortestPath.h"
+#include "paths.h"
 
 #include "fabric.h"
 #include "ibautils/ib_fabric.h"
@@ -46,78 +47,6 @@ shortestPath::shortestPath(tlp::PluginContext* context)
 {
 }
 
-//Find minimum distance between two nodes
-int shortestPath::nodes_map::min_distance(map<int, shortestPath::nodes_map::myNode*> map1, bool visited[]){
-    int min = INT_MAX;
-    int min_index = 0;
-
-    for(int i = 0; i<v; i++){
-        if(!visited[i] && map1[i]->getDist() < min)
-            min = map1[i]->getDist(), min_index = i;
-    }
-
-    return min_index;
-}
-
-//Dijkstra algorithm
-map<int,shortestPath::nodes_map::myNode*> shortestPath::nodes_map::dijkstra(int src) {
-    map<int, shortestPath::nodes_map::myNode*> distmap;
-    bool visited[v];
-
-    for (int i = 0; i < v; i++) {
-        distmap[i] = new shortestPath::nodes_map::myNode(i, INT_MAX);
-        visited[i] = false;
-    }
-    distmap[src]->setDist(0);
-
-    for (int count = 0; count < v - 1; count++) {
-        int u = min_distance(distmap, visited);
-        visited[u] = true;
-
-        for (int i = 0; i < v; i++) {
-            if (!visited[i] && adjacent_matrix[u][i] && distmap[u]->getDist() != INT_MAX &&
-                distmap[u]->getDist() + adjacent_matrix[u][i] < distmap[i]->getDist())
-            {
-                distmap[i]->setDist(distmap[u]->getDist() + adjacent_matrix[u][i]);
-                distmap[i]->setFrom(u);
-            }
-        }
-    }
-
-    return distmap;
-}
-
-vector<unsigned int> shortestPath::nodes_map::tracePath(map<int, shortestPath::nodes_map::myNode*> distmap, int target, int src){
-    vector<unsigned int> path;
-    unsigned int pos = target;
-    for(int i = 0; i<v-1; i++){
-        path.push_back(pos);
-        pos = distmap[pos]->getFrom();
-        if(pos == (unsigned int)src){
-            path.push_back(pos);
-            break;
-        }
-    }
-
-    return path;
-}
-
-//Find node from its id
-const tlp::node & shortestPath::find_node(unsigned int id){
-    tlp::Iterator<tlp::node> *itnodes = graph->getNodes();
-
-    while(itnodes->hasNext()){
-        const tlp::node &node = itnodes->next();
-        if(node.id == id)
-            return node;
-    }
-
-    itnodes = graph->getNodes();
-    const tlp::node &temp = itnodes->next();
-    delete itnodes;
-    return temp;
-}
-
 //Tulip's main function
 bool shortestPath::run()
 {
@@ -132,9 +61,6 @@ bool shortestPath::run()
         pluginProgress->progress(0, STEPS);
     }
 
-    //Store the total number of nodes
-    int v = graph->numberOfNodes();
-
     //Tulip's selection algorithm
     BooleanProperty *selectBool = graph->getLocalProperty<BooleanProperty>("viewSelection"); 
 
@@ -173,25 +99,33 @@ bool shortestPath::run()
     if(pluginProgress)
     {
         pluginProgress->progress(1, STEPS);
-        pluginProgress->setComment("Applying Dijkstra's algorithm to source node.");
+        pluginProgress->setComment("Applying BFS to source node.");
+    }
+
+    //Apply BFS from source node over the shared adjacency snapshot
+    const infiniband::adjacency_t &adjacency = infiniband::adjacency_t::find(graph);
+    const infiniband::adjacency_t::index_t source = adjacency.index(tlp::node(path_node[0]));
+    const infiniband::adjacency_t::index_t target = adjacency.index(tlp::node(path_node[1]));
+    if(source == infiniband::adjacency_t::INVALID_INDEX || target == infiniband::adjacency_t::INVALID_INDEX)
+    {
+      if(pluginProgress)
+        pluginProgress->setError("Selected nodes are not part of the graph");
+
+      return false;
     }
 
-    //Apply Dijkstra's algorithm from source node
-    nodes_map *graphAnalysis = new nodes_map(graph,v);
-    map<int, shortestPath::nodes_map::myNode*> mymap = graphAnalysis->dijkstra(path_node[0]);
+    infiniband::shortest_paths_t paths(adjacency);
+    paths.bfs(source);
     
         if(pluginProgress)
     {
         pluginProgress->progress(2, STEPS);
-        pluginProgress->setComment("Storing path found by Dijkstra's algorithm.");
+        pluginProgress->setComment("Storing path found by BFS.");
     }
 
     //Vector to store path edge indices
     std::vector<unsigned int> mypath;
 
-    //Iterator for all nodes in graph
-    tlp::Iterator<tlp::node> *itnodes = graph->getNodes();
-
         if(pluginProgress)
     {
         pluginProgress->progress(3, STEPS);
@@ -199,25 +133,29 @@ bool shortestPath::run()
     }
     
     //Select the found path
-    mypath = graphAnalysis->tracePath(mymap,path_node[1],path_node[0]);
-    tlp::ColorProperty * resetColor = graph->getLocalProperty<tlp::ColorProperty>("viewColor");
-    itnodes = graph->getNodes();
-    while(itnodes->hasNext()){
-        const tlp::node &node = itnodes->next();
-        for(unsigned int ID : mypath){
-            if(node.id == ID){
-                selectBool->setNodeValue(node, true);
-            }
-        }
+    const std::vector<infiniband::adjacency_t::index_t> trace = paths.trace(target);
+    for(size_t i = 0; i<trace.size(); i++)
+        mypath.push_back(adjacency.node(trace[i]).id);
+
+    //If the nodes are not connected show an error
+    if(mypath.empty())
+    {
+      if(pluginProgress)
+        pluginProgress->setError("No path between the selected nodes");
+
+      return false;
+    }
+
+    for(unsigned int ID : mypath){
+        selectBool->setNodeValue(tlp::node(ID), true);
     }
-    delete itnodes;
     
     for(unsigned int i = 0; i<mypath.size(); i++){
-        const tlp::node &source = find_node(mypath[i]);
+        const tlp::node source(mypath[i]);
         tlp::Iterator<tlp::edge> *itedges = graph->getOutEdges(source);
         while(itedges->hasNext()){
             const tlp::edge &edge = itedges->next();
-            if((i<mypath.size() && graph->target(edge).id == mypath[i+1]) 
+            if((i+1<mypath.size() && graph->target(edge).id == mypath[i+1]) 
                 || (i>0 && graph->target(edge).id == mypath[i-1])){
                 selectBool->setEdgeValue(edge, true);
             }
@@ -43,81 +43,9 @@ public:
 //Constructor
     shortestPath(tlp::PluginContext* context); 
 
-//Declaration of adjacency matrix
-    class nodes_map{
-    private:
-        int v; //number of nodes in graph;
-        int **adjacent_matrix;
-    public:
-        class myNode{
-        private:
-            int from;
-            int dist;
-        public:
-            myNode(int from, int dist = INT_MAX){
-                this->from = from;
-                this->dist = dist;
-            };
-
-            void setDist(int d){dist = d; }
-            int getDist(){return dist;}
-
-            void setFrom(int f){from = f;}
-            int getFrom(){return from;}
-        };
-
-    //Constructor
-    nodes_map(const Graph *graph, int v){
-        initMap(graph, v);
-    }
-
-    //Destructor
-    ~nodes_map(){
-        delete[] adjacent_matrix;
-    }
-
-    //Initialize adjacency matrix
-    void initMap(const Graph *graph, int v){
-        this->v = v;
-        adjacent_matrix = new int* [v];
-        for(int i = 0; i<v; i++){
-            adjacent_matrix[i] = new int[v];
-        }
-
-        //Initialize adjacency matrix
-        for(int i = 0; i<v; i++){
-            for(int j = 0; j<v; j++){
-                adjacent_matrix[i][j] = 0;
-            }
-        }
-
-        //Fill adjacency matrix
-        tlp::Iterator<edge> *ite = graph->getEdges();
-        while(ite->hasNext()){
-            edge e = ite->next();
-            int s = graph->source(e).id, t = graph->target(e).id;
-            if(!adjacent_matrix[s][t]){
-                adjacent_matrix[s][t] = 1;
-                adjacent_matrix[t][s] = 1;
-            }
-        }
-    }
-
-//Dijkstra Algorithm
-    //Calculate minimum distance between two nodes
-    int min_distance(map<int, myNode*> map1, bool visited[]);
-    
-    //Apply Dijkstra's algorithm to entire graph
-    map<int,myNode*> dijkstra(int src);
-
-    //Trace the path in Tulip
-    vector<unsigned int> tracePath(map<int, myNode*> distmap, int target,int src);
-    };
 
 //Main function
     bool run();
     
-//Return a node from its id
-    const tlp::node & find_node(unsigned int id);
 };
 #endif //SHORTEST_PATH_H
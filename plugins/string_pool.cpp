@@ -0,0 +1,67 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <stdint.h>
+#include "string_pool.h"
+
+namespace ib = infiniband;
+
+size_t ib::string_pool_t::key_hash_t::operator()(const key_t &key) const
+{
+  ///FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for(size_t i = 0; i < key.length; ++i)
+  {
+    hash ^= static_cast<unsigned char>(key.data[i]);
+    hash *= 1099511628211ULL;
+  }
+
+  return static_cast<size_t>(hash);
+}
+
+const std::string &ib::string_pool_t::intern(const char * const str, const size_t length)
+{
+  const key_t key = { str, length, NULL };
+  const std::unordered_set<key_t, key_hash_t, key_equal_t>::const_iterator itr = index.find(key);
+  if(itr != index.end())
+    return *itr->pooled;
+
+  strings.push_back(std::string(str, length));
+  const std::string &pooled = strings.back();
+
+  const key_t entry = { pooled.data(), pooled.size(), &pooled };
+  index.insert(entry);
+
+  return pooled;
+}
+
+size_t ib::string_pool_t::bytes() const
+{
+  size_t total = 0;
+  for(
+    std::deque<std::string>::const_iterator
+      itr = strings.begin(),
+      eitr = strings.end();
+    itr != eitr;
+    ++itr
+  )
+    total += itr->size();
+
+  return total;
+}
@@ -0,0 +1,114 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_set>
+
+#ifndef IB_TULIP_STRING_POOL_H
+#define IB_TULIP_STRING_POOL_H
+
+namespace infiniband
+{
+
+/**
+ * @brief Interned strings
+ *
+ * Every distinct string is stored once and handed out by reference.
+ * References stay valid until clear() as pooled strings never move.
+ * Lookups hash the characters in place, so only a string that is not
+ * pooled yet is copied (labels from the mapped fabric cache are never
+ * turned into a temporary std::string).
+ *
+ * Only meant to live while fields are built and written: Tulip's
+ * StringProperty keeps its own copy of every value, so a pool that
+ * outlives the write only adds memory.
+ */
+class string_pool_t
+{
+public:
+  /**
+   * @brief get pooled copy of string
+   */
+  const std::string &intern(const std::string &str)
+  {
+    return intern(str.data(), str.size());
+  }
+
+  const std::string &intern(const char * const str)
+  {
+    return intern(str, std::strlen(str));
+  }
+
+  /**
+   * @brief get pooled copy of length characters of str
+   */
+  const std::string &intern(const char * const str, const size_t length);
+
+  /**
+   * @brief number of distinct strings
+   */
+  size_t size() const { return strings.size(); }
+
+  /**
+   * @brief characters stored in the pool
+   */
+  size_t bytes() const;
+
+  void clear()
+  {
+    index.clear();
+    strings.clear();
+  }
+
+private:
+  /**
+   * @brief characters of a string, pooled string is NULL while looking up
+   */
+  struct key_t
+  {
+    const char *data;
+    size_t length;
+    const std::string *pooled;
+  };
+
+  struct key_hash_t
+  {
+    size_t operator()(const key_t &key) const;
+  };
+
+  struct key_equal_t
+  {
+    bool operator()(const key_t &a, const key_t &b) const
+    {
+      return a.length == b.length && !std::memcmp(a.data, b.data, a.length);
+    }
+  };
+
+  ///deque never moves its elements
+  std::deque<std::string> strings;
+  std::unordered_set<key_t, key_hash_t, key_equal_t> index;
+};
+
+}
+
+#endif // IB_TULIP_STRING_POOL_H
@@ -18,8 +18,12 @@
  *
  */
 
-#include<fstream>
+#include <algorithm>
+#include <memory>
+#include <sstream>
 #include "fabric.h"
+#include "ibnetdiscover.h"
+#include "progress.h"
 #include "topology.h"
 #include "ibautils/ib_fabric.h"
 #include "ibautils/ib_parser.h"
@@ -31,7 +35,7 @@ static const char * paramHelp[] = {
   HTML_HELP_OPEN() \
   HTML_HELP_DEF( "type", "pathname" ) \
   HTML_HELP_BODY() \
-  "Path to file to import" \
+  "Path to file to import (plain, gzip or zstd)" \
   HTML_HELP_CLOSE(),
   
   // Import Type
@@ -59,6 +63,55 @@ static const char * paramHelp[] = {
   HTML_HELP_BODY() \
   "Populate property fields of every node and cable in Tulip to allow other tools to use data." \
   HTML_HELP_CLOSE(),
+  
+  // Use Cache
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "bool" ) \
+  HTML_HELP_DEF( "default", "true" ) \
+  HTML_HELP_BODY() \
+  "Keep a binary cache of the parsed fabric next to the input file (&lt;file&gt;.ibcache) " \
+  "and use it instead of parsing when the input file has not changed." \
+  HTML_HELP_CLOSE(),
+
+  // Lazy Fields
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "bool" ) \
+  HTML_HELP_DEF( "default", "false" ) \
+  HTML_HELP_BODY() \
+  "Only create property fields when a plugin requests them (or via Infiniband Populate Fields) " \
+  "instead of during import. Requires Preserve Data." \
+  HTML_HELP_CLOSE(),
+
+  // Threads
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "0" ) \
+  HTML_HELP_BODY() \
+  "Threads used to parse the input file (0 for all cores). Small files are parsed by one thread." \
+  HTML_HELP_CLOSE(),
+
+  // Incremental
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "bool" ) \
+  HTML_HELP_DEF( "default", "true" ) \
+  HTML_HELP_BODY() \
+  "When importing again into a graph with preserved data, only add and delete the nodes and cables " \
+  "that changed. Everything else keeps its properties. Requires Preserve Data." \
+  HTML_HELP_CLOSE(),
+
+  // Timings
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "string" ) \
+  HTML_HELP_BODY() \
+  "Time spent in every stage of the import." \
+  HTML_HELP_CLOSE(),
+
+  // Changes
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "string" ) \
+  HTML_HELP_BODY() \
+  "Nodes and cables added, removed and changed by an incremental import." \
+  HTML_HELP_CLOSE(),
 };
 
 static const char IMPORT_TYPE_STRING[] = "ibnetdiscover -p";
@@ -74,6 +127,12 @@ ImportInfinibandTopology::ImportInfinibandTopology(tlp::PluginContext* context)
   addInParameter<tlp::StringCollection>("Import Type",paramHelp[1],IMPORT_TYPE_STRING);
   addInParameter<bool>("Preserve Data",paramHelp[2],"true");
   addInParameter<bool>("Populate Fields",paramHelp[3],"true");
+  addInParameter<bool>("Use Cache",paramHelp[4],"true");
+  addInParameter<bool>("Lazy Fields",paramHelp[5],"false");
+  addInParameter<int>("Threads",paramHelp[6],"0");
+  addInParameter<bool>("Incremental",paramHelp[7],"true");
+  addOutParameter<std::string>("Timings",paramHelp[8]);
+  addOutParameter<std::string>("Changes",paramHelp[9]);
 }
 
 namespace ib = infiniband;
@@ -83,21 +142,59 @@ bool ImportInfinibandTopology::importGraph()
 {
   assert(graph);
 
-  static const size_t STEPS = 5;
   if(pluginProgress)
-  {
     pluginProgress->showPreview(false);
-    pluginProgress->setComment("Starting to Import");
-    pluginProgress->progress(0, STEPS);
-  }
+
+  /**
+   * every stage is timed, parsing reports bytes
+   */
+  ib::import_progress_t progress(pluginProgress);
+  progress.stage("Starting to Import");
 
   bool preserveData = false;
   dataSet->get("Preserve Data", preserveData);
   bool populateFields = false;
   dataSet->get("Populate Fields", populateFields);
+  bool useCache = false;
+  dataSet->get("Use Cache", useCache);
+  bool lazyFields = false;
+  dataSet->get("Lazy Fields", lazyFields);
+  int threads = 0;
+  dataSet->get("Threads", threads);
+  bool incremental = false;
+  dataSet->get("Incremental", incremental);
 
-  ib::tulip_fabric_t * const fabric = preserveData ?  ib::tulip_fabric_t::find_fabric(graph, true) : new ib::tulip_fabric_t(graph);
-  assert(fabric);
+  ///Lazy fields are made from the preserved fabric
+  lazyFields = lazyFields && preserveData && populateFields;
+  if(lazyFields)
+    populateFields = false;
+
+  ///fields are written with a fixed type, never cast a field of another type
+  std::string conflict;
+  if(ib::tulip_fabric_t::find_field_conflict(graph, conflict))
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Field " + conflict + " already exists with another type.");
+
+    return false;
+  }
+
+  /**
+   * Importing again into a preserved fabric builds a new fabric
+   * that is diffed against it and then replaces it
+   */
+  ib::tulip_fabric_t * const previous = preserveData && incremental ? ib::tulip_fabric_t::find_fabric(graph, false) : NULL;
+  std::unique_ptr<ib::tulip_fabric_t> replacement(previous ? new ib::tulip_fabric_t(graph) : NULL);
+
+  ib::tulip_fabric_t * const fabric = previous ? replacement.get() : preserveData ?  ib::tulip_fabric_t::find_fabric(graph, true) : new ib::tulip_fabric_t(graph);
+  if(!fabric)
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable to load the preserved fabric from its cache.");
+
+    return false;
+  }
+  std::string changes;
 
   /**
    * Open file to read and import per type
@@ -106,38 +203,57 @@ bool ImportInfinibandTopology::importGraph()
     tlp::StringCollection import_types;
     std::string filename;
     
+    ///a missing or unreadable file is reported by the parser
     dataSet->get("file::filename", filename);
-    std::ifstream ifs(filename.c_str());
-    if(!ifs)
-      return false;
-    
+
     dataSet->get("Import Type", import_types);
 
     switch(import_types.getCurrent())
     {
       case IBNETDISCOVERP:
       {
-          ibp::ibnetdiscover_p_t parser;
-          ibp::ibnetdiscover_p_t::portmap_t portmap;
-          
-          if(pluginProgress)
+          /**
+           * Fast path: build graph from cache of unchanged file
+           * (only a fresh fabric into an empty graph, diffs and
+           * imports into a populated fabric need the parsed fabric)
+           */
+          ib::fabric_cache_t cache;
+          const bool fresh = !previous && fabric->entity_nodes.empty() && !graph->numberOfNodes();
+          if(useCache && fresh && cache.open(filename))
           {
-            pluginProgress->setComment("Starting to Import");
-            pluginProgress->progress(1, STEPS);
+            progress.stage("Populating Tulip from fabric cache");
+            fabric->populate(cache, filename, populateFields);
+            break;
           }
 
-          if(!parser.parse(portmap, ifs))
+          ibp::ibnetdiscover_p_t::portmap_t portmap;
+
+          /**
+           * Cancel drops the import, Stop keeps the cables parsed
+           * so far (a partial dump can not be diffed against the
+           * previous topology, it would delete everything not read)
+           */
+          progress.stage("Parsing");
+          if(
+            !ib::parse_ibnetdiscover_p(filename, portmap, std::max(threads, 0), progress.callback()) &&
+            (progress.get_state() != tlp::TLP_STOP || previous)
+          )
           {
             if(pluginProgress)
-              pluginProgress->setError("Unable to parse input file.");
+              pluginProgress->setError(
+                progress.get_state() == tlp::TLP_STOP ? "Import stopped, topology changes need the whole file." :
+                progress.cancelled() ? "Import cancelled." : "Unable to parse input file."
+              );
 
             return false;
           }
 
-          if(pluginProgress)
+          if(!progress.stage("Creating fabric from parsed cables") && progress.get_state() == tlp::TLP_CANCEL)
           {
-            pluginProgress->setComment("Creating fabric from parsed cables");
-            pluginProgress->progress(2, STEPS);
+            if(pluginProgress)
+              pluginProgress->setError("Import cancelled.");
+
+            return false;
           }
 
           if(!fabric->add_cables(portmap))
@@ -148,10 +264,12 @@ bool ImportInfinibandTopology::importGraph()
             return false;
           }
 
-          if(pluginProgress)
+          if(!progress.stage("Building LID map") && progress.get_state() == tlp::TLP_CANCEL)
           {
-            pluginProgress->setComment("Building LID map");
-            pluginProgress->progress(3, STEPS);
+            if(pluginProgress)
+              pluginProgress->setError("Import cancelled.");
+
+            return false;
           }
 
           if(!fabric->build_lid_map(true))
@@ -162,32 +280,61 @@ bool ImportInfinibandTopology::importGraph()
             return false;
           }
 
-          if(pluginProgress && populateFields)
+          /// Once a fabric is populated: populate the tulip graph
+          if(previous)
+          {
+            progress.stage("Applying topology changes");
+
+            ib::tulip_fabric_t::diff_t diff;
+            fabric->populate(*previous, populateFields, diff);
+            ib::tulip_fabric_t::replace_fabric(replacement.release());
+
+            std::ostringstream ss;
+            ss << "nodes +" << diff.nodes_added << " -" << diff.nodes_removed << " ~" << diff.nodes_changed <<
+              ", edges +" << diff.edges_added << " -" << diff.edges_removed << " ~" << diff.edges_changed;
+            changes = ss.str();
+          }
+          else
           {
-            pluginProgress->setComment("Populating Tulip Fields");
-            pluginProgress->progress(4, STEPS);
+            progress.stage(populateFields ? "Populating Tulip Fields" : "Populating Tulip");
+            fabric->populate(populateFields);
           }
 
-          /// Once a fabric is populated: populate the tulip graph
-          fabric->populate(populateFields);
+          ///never cache a stopped (partial) import
+          if(useCache && !progress.cancelled())
+          {
+            progress.stage("Writing fabric cache");
+            if(!ib::fabric_cache_t::write(filename, *fabric))
+            {
+#ifndef NDEBUG
+              std::cerr << "unable to write fabric cache for " << filename << std::endl;
+#endif
+            }
+          }
 
           break;
       }
     }
   }
   
+  if(lazyFields)
+    fabric->defer_fields();
+
   /**
    * Save fabric or release it
    */
   if(!preserveData)
     delete fabric;
 
+  const std::string timings = progress.finish();
+  dataSet->set("Timings", timings);
+  dataSet->set("Changes", changes);
+
   if(pluginProgress)
   {
-    pluginProgress->setComment("Done");
-    pluginProgress->progress(STEPS, STEPS);
+    pluginProgress->setComment((progress.cancelled() ? "Stopped (" : "Done (") + timings + (changes.empty() ? "" : "; " + changes) + ")");
+    pluginProgress->progress(1, 1);
   }
 
   return true;
 }
-
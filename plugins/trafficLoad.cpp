@@ -0,0 +1,349 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <tulip/DoubleProperty.h>
+#include "trafficLoad.h"
+#include "fabric.h"
+#include "forwarding.h"
+#include "input_stream.h"
+#include "ibautils/ib_fabric.h"
+
+PLUGIN(ProjectInfinibandTraffic)
+
+static const char * paramHelp[] = {
+  // File to Open
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "pathname" ) \
+  HTML_HELP_BODY() \
+  "Path to ibdiagnet2.fdbs file to import (plain, gzip or zstd)" \
+  HTML_HELP_CLOSE(),
+
+  // Traffic matrix
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "pathname" ) \
+  HTML_HELP_BODY() \
+  "CSV (plain, gzip or zstd) with source, destination and bytes per line. Endpoints are hex GUIDs (0x...), node names or hostnames." \
+  HTML_HELP_CLOSE(),
+
+  // Threads
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "integer" ) \
+  HTML_HELP_DEF( "default", "0" ) \
+  HTML_HELP_BODY() \
+  "Number of threads to use. 0 uses every core." \
+  HTML_HELP_CLOSE(),
+
+  // Max Load
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "double" ) \
+  HTML_HELP_BODY() \
+  "Highest predicted load of any edge in bytes." \
+  HTML_HELP_CLOSE(),
+
+  // Mean Load
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "double" ) \
+  HTML_HELP_BODY() \
+  "Mean predicted load of all fabric edges in bytes." \
+  HTML_HELP_CLOSE(),
+
+  // Congestion
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "double" ) \
+  HTML_HELP_BODY() \
+  "Max load divided by mean load. 1 is a perfectly balanced fabric." \
+  HTML_HELP_CLOSE(),
+
+  // Unrouted
+  HTML_HELP_OPEN() \
+  HTML_HELP_DEF( "type", "double" ) \
+  HTML_HELP_BODY() \
+  "Bytes between endpoints without a route." \
+  HTML_HELP_CLOSE()
+};
+
+ProjectInfinibandTraffic::ProjectInfinibandTraffic(tlp::PluginContext* context)
+  : tlp::Algorithm(context)
+{
+  addInParameter<std::string>("file::filename", paramHelp[0],"");
+  addInParameter<std::string>("file::traffic", paramHelp[1],"");
+  addInParameter<int>("Threads", paramHelp[2],"0");
+  addOutParameter<double>("Max Load", paramHelp[3]);
+  addOutParameter<double>("Mean Load", paramHelp[4]);
+  addOutParameter<double>("Congestion", paramHelp[5]);
+  addOutParameter<double>("Unrouted", paramHelp[6]);
+}
+
+namespace ib = infiniband;
+
+namespace
+{
+
+/**
+ * @brief traffic of every source to a single destination
+ */
+struct destination_t
+{
+  ib::forwarding_t::index_t destination;
+  std::vector<std::pair<ib::forwarding_t::index_t, double> > sources;
+};
+
+}
+
+bool ProjectInfinibandTraffic::run()
+{
+  assert(graph);
+
+  static const size_t STEPS = 5;
+  if(pluginProgress)
+  {
+    pluginProgress->showPreview(false);
+    pluginProgress->setComment("Starting Traffic Projection");
+    pluginProgress->progress(0, STEPS);
+  }
+
+  ib::tulip_fabric_t * const fabric = ib::tulip_fabric_t::find_fabric(graph, false);
+  if(!fabric)
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable find fabric. Make sure to preserve data when importing data.");
+
+    return false;
+  }
+
+  std::string filename;
+  std::string traffic_filename;
+  int threads = 0;
+
+  dataSet->get("file::filename", filename);
+  dataSet->get("file::traffic", traffic_filename);
+  dataSet->get("Threads", threads);
+
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Parsing Routes.");
+    pluginProgress->progress(1, STEPS);
+  }
+
+  if(!fabric->load_routes(filename))
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable open or parse routes file.");
+
+    return false;
+  }
+
+  const ib::forwarding_t &forwarding = fabric->get_forwarding();
+
+  /**
+   * read traffic matrix grouped per destination
+   */
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Reading traffic matrix.");
+    pluginProgress->progress(2, STEPS);
+  }
+
+  ///plain, gzip or zstd
+  ib::input_stream_t input;
+  if(!input.open(traffic_filename))
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Unable open traffic matrix file.");
+
+    return false;
+  }
+  std::istream is(&input);
+
+  const ib::endpoints_t endpoints(forwarding);
+  std::vector<ib::forwarding_t::index_t> destination_index(forwarding.size(), ib::forwarding_t::INVALID_INDEX);
+  std::vector<destination_t> destinations;
+  size_t unknown = 0;
+
+  std::string line;
+  while(std::getline(is, line))
+  {
+    const std::string::size_type first = line.find(',');
+    const std::string::size_type second = first == std::string::npos ? first : line.find(',', first + 1);
+    if(second == std::string::npos || line[0] == '#')
+      continue;
+
+    const ib::forwarding_t::index_t source = endpoints.find(line.substr(0, first));
+    const ib::forwarding_t::index_t destination = endpoints.find(line.substr(first + 1, second - first - 1));
+
+    char *end = NULL;
+    const double bytes = strtod(line.c_str() + second + 1, &end);
+
+    if(
+      source == ib::forwarding_t::INVALID_INDEX ||
+      destination == ib::forwarding_t::INVALID_INDEX ||
+      end == line.c_str() + second + 1
+    )
+    {
+      ///header or unknown endpoint
+#ifndef NDEBUG
+      std::cerr << "unknown traffic: " << line << std::endl;
+#endif
+      ++unknown;
+      continue;
+    }
+
+    if(destination_index[destination] == ib::forwarding_t::INVALID_INDEX)
+    {
+      destination_index[destination] = static_cast<ib::forwarding_t::index_t>(destinations.size());
+      destinations.push_back(destination_t());
+      destinations.back().destination = destination;
+    }
+
+    destinations[destination_index[destination]].sources.push_back(std::make_pair(source, bytes));
+  }
+  input.close();
+
+  if(input.failed())
+  {
+    if(pluginProgress)
+      pluginProgress->setError("Compressed traffic matrix file is truncated or corrupt.");
+
+    return false;
+  }
+
+  if(destinations.empty())
+  {
+    if(pluginProgress)
+      pluginProgress->setError("No known traffic found in traffic matrix file.");
+
+    return false;
+  }
+
+  /**
+   * push the traffic of every destination down its forwarding
+   * tree, each thread sums into its own edge array
+   */
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Projecting traffic onto routes.");
+    pluginProgress->progress(3, STEPS);
+  }
+
+  size_t edge_count = 0;
+  for(
+    ib::tulip_fabric_t::port_edges_t::const_iterator
+    itr = fabric->port_edges.begin(),
+    eitr = fabric->port_edges.end();
+    itr != eitr;
+    ++itr
+  )
+    edge_count = std::max<size_t>(edge_count, itr->second.id + 1);
+
+  unsigned int thread_count = threads > 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+  thread_count = std::min<size_t>(thread_count, destinations.size());
+
+  std::vector<std::vector<double> > edge_loads(thread_count);
+  std::vector<double> unrouted(thread_count, 0);
+  std::vector<std::thread> pool;
+
+  const size_t chunk = (destinations.size() + thread_count - 1) / thread_count;
+  for(unsigned int t = 0; t < thread_count; ++t)
+  {
+    const size_t first = std::min(destinations.size(), t * chunk);
+    const size_t last = std::min(destinations.size(), first + chunk);
+
+    pool.push_back(std::thread([&, t, first, last]()
+    {
+      std::vector<double> &edge_load = edge_loads[t];
+      edge_load.assign(edge_count, 0);
+
+      std::vector<double> load(forwarding.size(), 0);
+      for(size_t i = first; i < last; ++i)
+      {
+        const destination_t &destination = destinations[i];
+        for(size_t s = 0; s < destination.sources.size(); ++s)
+          load[destination.sources[s].first] += destination.sources[s].second;
+
+        unrouted[t] += forwarding.load_to(destination.destination, load, edge_load);
+      }
+    }));
+  }
+
+  for(size_t t = 0; t < pool.size(); ++t)
+    pool[t].join();
+
+  for(size_t t = 1; t < edge_loads.size(); ++t)
+  {
+    for(size_t e = 0; e < edge_count; ++e)
+      edge_loads[0][e] += edge_loads[t][e];
+
+    unrouted[0] += unrouted[t];
+  }
+
+  /**
+   * store load and congestion statistics
+   */
+  if(pluginProgress)
+  {
+    pluginProgress->setComment("Storing predicted load.");
+    pluginProgress->progress(4, STEPS);
+  }
+
+  tlp::DoubleProperty * ibPredictedLoad = graph->getProperty<tlp::DoubleProperty>("ibPredictedLoad");
+  assert(ibPredictedLoad);
+
+  ibPredictedLoad->setAllEdgeValue(0);
+
+  double max_load = 0;
+  double total_load = 0;
+  size_t fabric_edges = 0;
+  for(
+    ib::tulip_fabric_t::port_edges_t::const_iterator
+    itr = fabric->port_edges.begin(),
+    eitr = fabric->port_edges.end();
+    itr != eitr;
+    ++itr
+  )
+  {
+    const double load = edge_loads[0][itr->second.id];
+    ibPredictedLoad->setEdgeValue(itr->second, load);
+
+    max_load = std::max(max_load, load);
+    total_load += load;
+    ++fabric_edges;
+  }
+
+  const double mean_load = fabric_edges ? total_load / fabric_edges : 0;
+
+  dataSet->set("Max Load", max_load);
+  dataSet->set("Mean Load", mean_load);
+  dataSet->set("Congestion", mean_load > 0 ? max_load / mean_load : 0);
+  dataSet->set("Unrouted", unrouted[0]);
+
+  if(pluginProgress)
+  {
+    std::stringstream comment;
+    comment << "Projected traffic to " << destinations.size() << " destinations, skipped " << unknown << " unknown lines.";
+    pluginProgress->setComment(comment.str());
+    pluginProgress->progress(STEPS, STEPS);
+  }
+
+  return true;
+}
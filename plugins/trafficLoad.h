@@ -0,0 +1,51 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <tulip/TulipPluginHeaders.h>
+
+#ifndef IB_TRAFFIC_LOAD_H
+#define IB_TRAFFIC_LOAD_H
+
+/**
+ * @brief Project a traffic matrix onto the fabric links
+ *
+ * Every (source, destination, bytes) entry is added to each edge along
+ * the LFT route from source to destination. Uses the routes and fabric
+ * retained on the graph by earlier imports.
+ */
+class ProjectInfinibandTraffic: public tlp::Algorithm {
+public:
+  PLUGININFORMATION("Infiniband Traffic Projection",
+                    "NCAR",
+                    "10/17/26",
+                    "Predict link load from a traffic matrix CSV (source, destination, bytes) using the real routes. Stores bytes per edge in ibPredictedLoad.",
+                    "alpha",
+                    "Infiniband")
+
+  ProjectInfinibandTraffic(tlp::PluginContext* context);
+
+  /**
+   * @brief project traffic matrix onto ibPredictedLoad
+   */
+  bool run();
+};
+
+#endif // IB_TRAFFIC_LOAD_H
@@ -0,0 +1,51 @@
+/**
+ *
+ * This file is part of Tulip (www.tulip-software.org)
+ *
+ * Authors: David Auber and the Tulip development Team
+ * from LaBRI, University of Bordeaux, University Corporation 
+ * for Atmospheric Research
+ *
+ * Tulip is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation, either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * Tulip is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <tulip/Graph.h>
+
+#ifndef IB_TULIP_TYPED_PROPERTY_H
+#define IB_TULIP_TYPED_PROPERTY_H
+
+namespace infiniband
+{
+
+/**
+ * @brief get property of graph unless its name is taken by another type
+ *
+ * graph->getProperty<P>() casts whatever property has the name, so a
+ * property of another type (such as a field saved by an older version
+ * as string or double) has to be refused first.
+ *
+ * @return property or NULL if name belongs to a property of another type
+ */
+template<class P>
+P *get_typed_property(tlp::Graph * const graph, const std::string &name)
+{
+  if(graph->existProperty(name) && graph->getProperty(name)->getTypename() != P::propertyTypename)
+    return NULL;
+
+  return graph->getProperty<P>(name);
+}
+
+}
+
+#endif // IB_TULIP_TYPED_PROPERTY_H